@@ -33,12 +33,28 @@ static const CGFloat shadowSize = 10;
         shadowRect.size.width += shadowSize;
     }
     
+    // Paths are shared between views of the same size, nothing needs updating if it's already in use
+    static NSCache *shadowPaths;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        shadowPaths = [[NSCache alloc] init];
+    });
+    
+    NSString *key = NSStringFromCGRect(shadowRect);
+    UIBezierPath *shadowPath = [shadowPaths objectForKey:key];
+    if(shadowPath == nil) {
+        shadowPath = [UIBezierPath bezierPathWithRect:shadowRect];
+        [shadowPaths setObject:shadowPath forKey:key];
+    } else if(self.layer.shadowPath == shadowPath.CGPath) {
+        return;
+    }
+    
     self.layer.masksToBounds = NO;
     self.layer.shadowRadius = 5;
     self.layer.shadowOffset = CGSizeZero;
     self.layer.shadowOpacity = 0.25;
     
-    self.layer.shadowPath = [UIBezierPath bezierPathWithRect:shadowRect].CGPath;
+    self.layer.shadowPath = shadowPath.CGPath;
 }
 
 @end
@@ -0,0 +1,46 @@
+//
+//  SCImagePipeline.h
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+@import UIKit;
+
+/** Decodes bundled images off the main thread, downsampled to the size they
+ * will be displayed at, and keeps the bitmaps in a cache shared by all the
+ * panels.
+ *
+ * Images requested by visible panels are kept in memory until relinquished,
+ * everything else gets evicted, least recently used first, once the cache
+ * goes over its byte budget.
+ *
+ * The pipeline isn't thread safe, it must only be used from the main thread.
+ * Decoding happens in the background but the results are handed back to the
+ * main thread before they touch any state.
+ */
+@interface SCImagePipeline : NSObject
+
++ (instancetype)sharedPipeline;
+
+/** Maximum number of bytes the decoded bitmaps not currently in use can take up, defaults to 32MB */
+@property (nonatomic, assign) NSUInteger byteBudget;
+
+/** Starts decoding an image at low priority so that it's ready by the time it's requested */
+- (void)prefetchImageNamed:(NSString *)name size:(CGSize)size;
+
+/** Balances a prefetchImageNamed:size: call, the decode is dropped if nothing else wants the image */
+- (void)cancelPrefetchImageNamed:(NSString *)name size:(CGSize)size;
+
+/** Fetches an image and keeps it in memory until relinquished
+ *
+ * The completion block is called on the main thread, right away if the image
+ * was already decoded.
+ */
+- (void)requestImageNamed:(NSString *)name size:(CGSize)size completion:(void(^)(UIImage *image))completion;
+
+/** Balances a requestImageNamed:size:completion: call, the image can be evicted once nobody uses it */
+- (void)relinquishImageNamed:(NSString *)name size:(CGSize)size;
+
+@end
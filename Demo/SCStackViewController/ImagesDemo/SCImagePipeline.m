@@ -0,0 +1,296 @@
+//
+//  SCImagePipeline.m
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "SCImagePipeline.h"
+
+@import ImageIO;
+
+@interface SCImagePipeline ()
+
+@property (nonatomic, strong) NSMutableDictionary *images;
+@property (nonatomic, strong) NSMutableDictionary *costs;
+@property (nonatomic, strong) NSMutableOrderedSet *recentlyUsedKeys;
+@property (nonatomic, strong) NSCountedSet *keysInUse;
+@property (nonatomic, strong) NSCountedSet *prefetchedKeys;
+@property (nonatomic, assign) NSUInteger totalCost;
+
+@property (nonatomic, strong) NSOperationQueue *decodeQueue;
+@property (nonatomic, strong) NSMutableDictionary *decodeOperations;
+@property (nonatomic, strong) NSMutableDictionary *pendingCompletions;
+
+@end
+
+@implementation SCImagePipeline
+
++ (instancetype)sharedPipeline
+{
+	static SCImagePipeline *sharedPipeline;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedPipeline = [[SCImagePipeline alloc] init];
+	});
+	
+	return sharedPipeline;
+}
+
+- (void)dealloc
+{
+	[[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (instancetype)init
+{
+	if(self = [super init]) {
+		self.images = [NSMutableDictionary dictionary];
+		self.costs = [NSMutableDictionary dictionary];
+		self.recentlyUsedKeys = [NSMutableOrderedSet orderedSet];
+		self.keysInUse = [NSCountedSet set];
+		self.prefetchedKeys = [NSCountedSet set];
+		self.decodeOperations = [NSMutableDictionary dictionary];
+		self.pendingCompletions = [NSMutableDictionary dictionary];
+		
+		self.decodeQueue = [[NSOperationQueue alloc] init];
+		[self.decodeQueue setMaxConcurrentOperationCount:2];
+		
+		self.byteBudget = 32 * 1024 * 1024;
+		
+		[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_onMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+	}
+	
+	return self;
+}
+
+- (void)setByteBudget:(NSUInteger)byteBudget
+{
+	NSAssert([NSThread isMainThread], @"The image pipeline can only be used from the main thread");
+	
+	_byteBudget = byteBudget;
+	[self _evictImagesIfNecessary];
+}
+
+- (void)prefetchImageNamed:(NSString *)name size:(CGSize)size
+{
+	NSAssert([NSThread isMainThread], @"The image pipeline can only be used from the main thread");
+	
+	NSString *key = [self _keyForImageNamed:name size:size];
+	[self.prefetchedKeys addObject:key];
+	
+	if(self.images[key] || self.decodeOperations[key]) {
+		return;
+	}
+	
+	[self _decodeImageNamed:name size:size key:key priority:NSOperationQueuePriorityLow];
+}
+
+- (void)cancelPrefetchImageNamed:(NSString *)name size:(CGSize)size
+{
+	NSAssert([NSThread isMainThread], @"The image pipeline can only be used from the main thread");
+	
+	NSString *key = [self _keyForImageNamed:name size:size];
+	[self.prefetchedKeys removeObject:key];
+	
+	// Requested images keep decoding, so do the ones other panels still prefetch
+	if([self.prefetchedKeys countForObject:key] > 0 || [self.keysInUse countForObject:key] > 0) {
+		return;
+	}
+	
+	[self.decodeOperations[key] cancel];
+	[self.decodeOperations removeObjectForKey:key];
+	[self.pendingCompletions removeObjectForKey:key];
+}
+
+- (void)requestImageNamed:(NSString *)name size:(CGSize)size completion:(void(^)(UIImage *image))completion
+{
+	NSAssert([NSThread isMainThread], @"The image pipeline can only be used from the main thread");
+	
+	NSString *key = [self _keyForImageNamed:name size:size];
+	[self.keysInUse addObject:key];
+	
+	UIImage *image = self.images[key];
+	if(image) {
+		[self _markKeyAsRecentlyUsed:key];
+		
+		if(completion) {
+			completion(image);
+		}
+		return;
+	}
+	
+	if(completion) {
+		[self _addPendingCompletion:completion forKey:key];
+	}
+	
+	// Visible panels can't wait behind prefetches, bump an already queued decode instead of starting another one
+	NSOperation *operation = self.decodeOperations[key];
+	if(operation) {
+		[operation setQueuePriority:NSOperationQueuePriorityHigh];
+	} else {
+		[self _decodeImageNamed:name size:size key:key priority:NSOperationQueuePriorityHigh];
+	}
+}
+
+- (void)relinquishImageNamed:(NSString *)name size:(CGSize)size
+{
+	NSAssert([NSThread isMainThread], @"The image pipeline can only be used from the main thread");
+	
+	NSString *key = [self _keyForImageNamed:name size:size];
+	[self.keysInUse removeObject:key];
+	
+	[self _evictImagesIfNecessary];
+}
+
+#pragma mark - Private
+
+- (NSString *)_keyForImageNamed:(NSString *)name size:(CGSize)size
+{
+	return [NSString stringWithFormat:@"%@-%@", name, NSStringFromCGSize(size)];
+}
+
+- (void)_addPendingCompletion:(void(^)(UIImage *image))completion forKey:(NSString *)key
+{
+	NSMutableArray *completions = self.pendingCompletions[key];
+	if(completions == nil) {
+		completions = [NSMutableArray array];
+		[self.pendingCompletions setObject:completions forKey:key];
+	}
+	
+	[completions addObject:[completion copy]];
+}
+
+- (void)_decodeImageNamed:(NSString *)name size:(CGSize)size key:(NSString *)key priority:(NSOperationQueuePriority)priority
+{
+	if(self.pendingCompletions[key] == nil) {
+		[self.pendingCompletions setObject:[NSMutableArray array] forKey:key];
+	}
+	
+	CGFloat scale = [UIScreen mainScreen].scale;
+	
+	NSBlockOperation *operation = [[NSBlockOperation alloc] init];
+	__weak NSBlockOperation *weakOperation = operation;
+	[operation addExecutionBlock:^{
+		
+		// Cancelled prefetches that didn't start yet skip the decode altogether
+		NSBlockOperation *strongOperation = weakOperation;
+		if(strongOperation == nil || strongOperation.isCancelled) {
+			return;
+		}
+		
+		UIImage *image = [SCImagePipeline _downsampledImageNamed:name size:size scale:scale];
+		
+		// Only the decode runs in the background, the pipeline's state is only touched on the main thread
+		dispatch_async(dispatch_get_main_queue(), ^{
+			if(strongOperation.isCancelled || self.decodeOperations[key] != strongOperation) {
+				return;
+			}
+			
+			NSArray *completions = self.pendingCompletions[key];
+			
+			[self.decodeOperations removeObjectForKey:key];
+			[self.pendingCompletions removeObjectForKey:key];
+			
+			if(image) {
+				CGImageRef imageRef = image.CGImage;
+				NSUInteger cost = CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef);
+				
+				[self.images setObject:image forKey:key];
+				[self.costs setObject:@(cost) forKey:key];
+				self.totalCost += cost;
+				
+				[self _markKeyAsRecentlyUsed:key];
+			}
+			
+			for(void(^completion)(UIImage *) in completions) {
+				completion(image);
+			}
+			
+			[self _evictImagesIfNecessary];
+		});
+	}];
+	
+	[operation setQueuePriority:priority];
+	[self.decodeOperations setObject:operation forKey:key];
+	[self.decodeQueue addOperation:operation];
+}
+
+// Decodes straight into a bitmap just big enough to aspect fill the given size
++ (UIImage *)_downsampledImageNamed:(NSString *)name size:(CGSize)size scale:(CGFloat)scale
+{
+	NSURL *url = [[NSBundle mainBundle] URLForResource:name withExtension:nil];
+	if(url == nil) {
+		return nil;
+	}
+	
+	CGImageSourceRef source = CGImageSourceCreateWithURL((__bridge CFURLRef)url, (__bridge CFDictionaryRef)@{(id)kCGImageSourceShouldCache : @NO});
+	if(source == NULL) {
+		return nil;
+	}
+	
+	NSDictionary *properties = (__bridge_transfer NSDictionary *)CGImageSourceCopyPropertiesAtIndex(source, 0, NULL);
+	CGFloat pixelWidth = [properties[(id)kCGImagePropertyPixelWidth] floatValue];
+	CGFloat pixelHeight = [properties[(id)kCGImagePropertyPixelHeight] floatValue];
+	
+	CGFloat maxPixelSize = MAX(pixelWidth, pixelHeight);
+	if(pixelWidth > 0.0f && pixelHeight > 0.0f && size.width > 0.0f && size.height > 0.0f) {
+		CGFloat fillScale = MAX(size.width * scale / pixelWidth, size.height * scale / pixelHeight);
+		maxPixelSize = MIN(maxPixelSize, ceilf(maxPixelSize * fillScale));
+	}
+	
+	NSDictionary *options = (@{(id)kCGImageSourceCreateThumbnailFromImageAlways : @YES,
+							   (id)kCGImageSourceCreateThumbnailWithTransform   : @YES,
+							   (id)kCGImageSourceShouldCacheImmediately         : @YES,
+							   (id)kCGImageSourceThumbnailMaxPixelSize          : @(maxPixelSize)});
+	
+	CGImageRef imageRef = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)options);
+	CFRelease(source);
+	
+	if(imageRef == NULL) {
+		return nil;
+	}
+	
+	UIImage *image = [UIImage imageWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+	CGImageRelease(imageRef);
+	
+	return image;
+}
+
+- (void)_markKeyAsRecentlyUsed:(NSString *)key
+{
+	[self.recentlyUsedKeys removeObject:key];
+	[self.recentlyUsedKeys addObject:key];
+}
+
+- (void)_evictImagesIfNecessary
+{
+	[self _evictImagesDownToCost:self.byteBudget];
+}
+
+// Only images nobody is displaying get evicted, least recently used first
+- (void)_evictImagesDownToCost:(NSUInteger)cost
+{
+	NSUInteger index = 0;
+	while(self.totalCost > cost && index < self.recentlyUsedKeys.count) {
+		NSString *key = self.recentlyUsedKeys[index];
+		
+		if([self.keysInUse countForObject:key] > 0) {
+			index++;
+			continue;
+		}
+		
+		self.totalCost -= [self.costs[key] unsignedIntegerValue];
+		[self.images removeObjectForKey:key];
+		[self.costs removeObjectForKey:key];
+		[self.recentlyUsedKeys removeObjectAtIndex:index];
+	}
+}
+
+- (void)_onMemoryWarning:(NSNotification *)notification
+{
+	[self _evictImagesDownToCost:0];
+}
+
+@end
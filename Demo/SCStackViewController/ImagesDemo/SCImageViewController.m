@@ -7,7 +7,9 @@
 //
 
 #import "SCImageViewController.h"
-#import "UIView+Shadows.h"
+#import "SCImagePipeline.h"
+
+static NSString *const kImageName = @"panorama.jpg";
 
 @interface SCImageViewController ()
 
@@ -17,6 +19,12 @@
 @property (nonatomic, weak) IBOutlet UIView *controlsContainer;
 @property (nonatomic, weak) IBOutlet UILabel *visiblePercentageLabel;
 
+@property (nonatomic, assign) BOOL isDisplayingImage;
+@property (nonatomic, assign) CGSize displayedImageSize;
+
+@property (nonatomic, assign) BOOL isPrefetchingNextImage;
+@property (nonatomic, assign) CGSize prefetchedImageSize;
+
 @end
 
 @implementation SCImageViewController
@@ -31,18 +39,50 @@
 	return self;
 }
 
-- (void)viewDidLoad
+- (void)dealloc
 {
-	[super viewDidLoad];
-	[self updateShadow];
+	if(self.isDisplayingImage) {
+		[[SCImagePipeline sharedPipeline] relinquishImageNamed:kImageName size:self.displayedImageSize];
+	}
 	
-	[self.backgroundImageView setImage:[UIImage imageNamed:@"panorama.jpg"]];
+	[self _cancelNextImagePrefetch];
 }
 
-- (void)viewWillLayoutSubviews
+- (void)didMoveToParentViewController:(UIViewController *)parent
 {
-	[super viewWillLayoutSubviews];
-	[self updateShadow];
+	[super didMoveToParentViewController:parent];
+	
+	if(![parent isKindOfClass:[SCStackViewController class]]) {
+		[self _cancelNextImagePrefetch];
+		return;
+	}
+	
+	// The panel stacked after a visible one is the next to scroll in, decode its image while this one is on screen
+	__weak typeof(self) weakSelf = self;
+	[(SCStackViewController *)parent registerVisibilityObserverForViewController:self thresholds:@[@(0.0f)] handler:^(UIViewController *viewController, CGFloat threshold, CGFloat visiblePercentage) {
+		if(visiblePercentage > 0.0f) {
+			[weakSelf _prefetchNextImage];
+		} else {
+			[weakSelf _cancelNextImagePrefetch];
+		}
+	}];
+	
+	// Observers only report crossings that happen after the registration, panels already on screen start prefetching now
+	if([(SCStackViewController *)parent visiblePercentageForViewController:self] > 0.0f) {
+		[self _prefetchNextImage];
+	}
+}
+
+- (void)viewWillAppear:(BOOL)animated
+{
+	[super viewWillAppear:animated];
+	[self _displayImage];
+}
+
+- (void)viewDidDisappear:(BOOL)animated
+{
+	[super viewDidDisappear:animated];
+	[self _hideImage];
 }
 
 - (void)setVisiblePercentage:(CGFloat)percentage
@@ -69,20 +109,90 @@
 	[self.sc_stackViewController navigateToViewController:self animated:YES completion:nil];
 }
 
-- (void)updateShadow
+#pragma mark - Private
+
+- (CGSize)_imageSize
+{
+	if([self.parentViewController isKindOfClass:[SCStackViewController class]]) {
+		CGRect finalFrame = [(SCStackViewController *)self.parentViewController finalFrameForViewController:self];
+		if(!CGRectIsNull(finalFrame)) {
+			return finalFrame.size;
+		}
+	}
+	
+	return (self.isViewLoaded ? self.view.bounds.size : [UIScreen mainScreen].bounds.size);
+}
+
+- (void)_displayImage
 {
-	static NSDictionary *positionToShadowEdge;
-	static dispatch_once_t onceToken;
-	dispatch_once(&onceToken, ^{
-		positionToShadowEdge = (@{
-								  @(SCStackViewControllerPositionTop)    : @(SCShadowEdgeTop),
-								  @(SCStackViewControllerPositionLeft)   : @(SCShadowEdgeLeft),
-								  @(SCStackViewControllerPositionBottom) : @(SCShadowEdgeBottom),
-								  @(SCStackViewControllerPositionRight)  : @(SCShadowEdgeRight)
-								  });
-	});
-	
-	[self.backgroundImageView castShadowWithPosition:(SCShadowEdge)[positionToShadowEdge[@(self.position)] intValue]];
+	if(self.isDisplayingImage) {
+		return;
+	}
+	
+	self.isDisplayingImage = YES;
+	self.displayedImageSize = [self _imageSize];
+	
+	CGSize size = self.displayedImageSize;
+	__weak typeof(self) weakSelf = self;
+	[[SCImagePipeline sharedPipeline] requestImageNamed:kImageName size:size completion:^(UIImage *image) {
+		if(weakSelf.isDisplayingImage && CGSizeEqualToSize(weakSelf.displayedImageSize, size)) {
+			[weakSelf.backgroundImageView setImage:image];
+		}
+	}];
+}
+
+- (SCImageViewController *)_nextPanel
+{
+	NSArray *viewControllers = [self.sc_stackViewController viewControllersForPosition:self.position];
+	NSUInteger index = [viewControllers indexOfObject:self];
+	
+	if(index == NSNotFound || index + 1 >= viewControllers.count) {
+		return nil;
+	}
+	
+	id nextViewController = viewControllers[index + 1];
+	return ([nextViewController isKindOfClass:[SCImageViewController class]] ? nextViewController : nil);
+}
+
+- (void)_prefetchNextImage
+{
+	if(self.isPrefetchingNextImage) {
+		return;
+	}
+	
+	SCImageViewController *nextPanel = [self _nextPanel];
+	if(nextPanel == nil) {
+		return;
+	}
+	
+	self.isPrefetchingNextImage = YES;
+	self.prefetchedImageSize = [nextPanel _imageSize];
+	
+	[[SCImagePipeline sharedPipeline] prefetchImageNamed:kImageName size:self.prefetchedImageSize];
+}
+
+// Panels scrolling away stop decoding for their neighbours, unless those already requested the image themselves
+- (void)_cancelNextImagePrefetch
+{
+	if(!self.isPrefetchingNextImage) {
+		return;
+	}
+	
+	self.isPrefetchingNextImage = NO;
+	[[SCImagePipeline sharedPipeline] cancelPrefetchImageNamed:kImageName size:self.prefetchedImageSize];
+}
+
+// Hidden panels let go of their bitmaps so the pipeline can evict them when over budget
+- (void)_hideImage
+{
+	if(!self.isDisplayingImage) {
+		return;
+	}
+	
+	self.isDisplayingImage = NO;
+	[self.backgroundImageView setImage:nil];
+	
+	[[SCImagePipeline sharedPipeline] relinquishImageNamed:kImageName size:self.displayedImageSize];
 }
 
 @end
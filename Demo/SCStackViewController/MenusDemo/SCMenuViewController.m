@@ -7,7 +7,6 @@
 //
 
 #import "SCMenuViewController.h"
-#import "UIView+Shadows.h"
 #import "UIColor+RandomColors.h"
 
 @interface SCMenuViewController ()
@@ -37,7 +36,6 @@
 - (void)viewDidLoad
 {
 	[super viewDidLoad];
-	[self updateShadow];
 	
 	[self.contentView setBackgroundColor:[UIColor randomColorWithAlpha:1.0f]];
 	
@@ -61,12 +59,6 @@
 	}
 }
 
-- (void)viewWillLayoutSubviews
-{
-	[super viewWillLayoutSubviews];
-	[self updateShadow];
-}
-
 - (void)setVisiblePercentage:(CGFloat)percentage
 {
 	[self.visiblePercentageLabel setText:[NSString stringWithFormat:@"%.3f%%", percentage]];
@@ -91,18 +83,4 @@
 	[self.sc_stackViewController navigateToViewController:self animated:YES completion:nil];
 }
 
-- (void)updateShadow
-{
-	static NSDictionary *positionToShadowEdge;
-	static dispatch_once_t onceToken;
-	dispatch_once(&onceToken, ^{
-		positionToShadowEdge = (@{@(SCStackViewControllerPositionTop)    : @(SCShadowEdgeTop),
-								  @(SCStackViewControllerPositionLeft)   : @(SCShadowEdgeLeft),
-								  @(SCStackViewControllerPositionBottom) : @(SCShadowEdgeBottom),
-								  @(SCStackViewControllerPositionRight)  : @(SCShadowEdgeRight)});
-	});
-	
-	[self.contentView castShadowWithPosition:(SCShadowEdge)[positionToShadowEdge[@(self.position)] intValue]];
-}
-
 @end
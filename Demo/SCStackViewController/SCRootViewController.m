@@ -12,6 +12,7 @@
 #import "SCScrollView.h"
 
 #import "SCStackNavigationStep.h"
+#import "SCStackDecoration.h"
 #import "SCEasingFunction.h"
 
 #import "SCMainViewController.h"
@@ -40,9 +41,13 @@
 @property (nonatomic, strong) IBOutlet SCMainViewController *mainViewController;
 @property (nonatomic, strong) SCOverlayView *overlayView;
 
+@property (nonatomic, strong) SCStackDecoration *edgeDecoration;
+
 @property (nonatomic, strong) UIButton *leftMenuButton;
 @property (nonatomic, strong) UIButton *rightMenuButton;
 
+@property (nonatomic, strong) NSHashTable *observedViewControllers;
+
 @property (nonatomic, assign) SCStackDemoType currentDemoType;
 
 @end
@@ -59,6 +64,8 @@
 	[self.mainViewController.view addSubview:self.overlayView];
 	[self.overlayView setFrame:self.mainViewController.view.bounds];
 	
+	self.edgeDecoration = [[SCStackDecoration alloc] init];
+	[self.edgeDecoration setMaximumDimmingOpacity:0.25f];
 	
 	[self.stackViewController willMoveToParentViewController:self];
 	
@@ -131,7 +138,7 @@
 	
 	id<SCStackLayouterProtocol> layouter = [[typeToLayouter[@(type)] alloc] init];
 	[layouter setShouldStackControllersAboveRoot:YES];
-	[self _registerLayouter:layouter];
+	[self _registerLayouter:layouter decoration:self.edgeDecoration];
 }
 
 - (void)mainViewController:(SCMainViewController *)mainViewController didChangeAnimationType:(SCEasingFunctionType)type
@@ -190,18 +197,14 @@
 {
 	[self.overlayView setAlpha:ABS((offset.x ?: offset.y) / 300.0f)];
 	
-	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
-		for(SCImageViewController *viewController in [self.stackViewController viewControllersForPosition:position]) {
-			[viewController setVisiblePercentage:[stackViewController visiblePercentageForViewController:viewController]];
-		}
-	}
-	
-	[self.mainViewController setVisiblePercentage:[stackViewController visiblePercentageForViewController:self.mainViewController]];
-	
-	
 	[self _updateMenuButtonsWithContentOffset:offset];
 }
 
+- (void)stackViewController:(SCStackViewController *)stackViewController didShowViewController:(UIViewController *)controller position:(SCStackViewControllerPosition)position
+{
+	[self _observeVisibilityOfViewController:(UIViewController<SCStackedViewControllerProtocol> *)controller];
+}
+
 #pragma mark - SCOverlayViewDelegate
 
 - (void)overlayViewDidReceiveTap:(SCOverlayView *)overlayView
@@ -215,7 +218,7 @@
 {
 	SCImagesLayouter *imagesLayouter = [[SCImagesLayouter alloc] init];
 	[imagesLayouter setShouldStackControllersAboveRoot:YES];
-	[self _registerLayouter:imagesLayouter];
+	[self _registerLayouter:imagesLayouter decoration:self.edgeDecoration];
 	
 	[self.stackViewController setAnimationDuration:1.25f];
 	[self.stackViewController setEasingFunction:[SCEasingFunction easingFunctionWithType:SCEasingFunctionTypeElasticEaseOut]];
@@ -238,7 +241,7 @@
 {
 	SCMenusLayouter *menusLayouter = [[SCMenusLayouter alloc] init];
 	[menusLayouter setShouldStackControllersAboveRoot:YES];
-	[self _registerLayouter:menusLayouter];
+	[self _registerLayouter:menusLayouter decoration:self.edgeDecoration];
 	
 	[self.stackViewController setAnimationDuration:0.75f];
 	[self.stackViewController setEasingFunction:[SCEasingFunction easingFunctionWithType:SCEasingFunctionTypeExponentialEaseOut]];
@@ -270,7 +273,7 @@
 {
 	SCStackLayouter *titleBarLayouter = [[SCStackLayouter alloc] init];
 	[titleBarLayouter setShouldStackControllersAboveRoot:YES];
-	[self _registerLayouter:titleBarLayouter];
+	[self _registerLayouter:titleBarLayouter decoration:self.edgeDecoration];
 	
 	[self.stackViewController setAnimationDuration:1.0f];
 	[self.stackViewController setEasingFunction:[SCEasingFunction easingFunctionWithType:SCEasingFunctionTypeBounceEaseOut]];
@@ -297,7 +300,9 @@
 {
 	SCModalLayouter *modalLayouter = [[SCModalLayouter alloc] init];
 	[modalLayouter setShouldStackControllersAboveRoot:YES];
-	[self _registerLayouter:modalLayouter];
+	
+	// The modal's content is inset within its view and casts its own shadow
+	[self _registerLayouter:modalLayouter decoration:nil];
 	
 	[self.stackViewController setAnimationDuration:1.5f];
 	[self.stackViewController setEasingFunction:[SCEasingFunction easingFunctionWithType:SCEasingFunctionTypeElasticEaseOut]];
@@ -320,7 +325,7 @@
 {
 	SCStackLayouter *plainLayouter = [[SCStackLayouter alloc] init];
 	[plainLayouter setShouldStackControllersAboveRoot:YES];
-	[self _registerLayouter:plainLayouter];
+	[self _registerLayouter:plainLayouter decoration:self.edgeDecoration];
 	
 	[self.stackViewController setAnimationDuration:0.25f];
 	[self.stackViewController setEasingFunction:[SCEasingFunction easingFunctionWithType:SCEasingFunctionTypeLinear]];
@@ -348,10 +353,31 @@
 	[self.mainViewController showAnimationOptionsAnimated:YES];
 }
 
-- (void)_registerLayouter:(id<SCStackLayouterProtocol>)layouter
+// Observers outlive the appearances, register them only once per view controller and with a few thresholds
+- (void)_observeVisibilityOfViewController:(UIViewController<SCStackedViewControllerProtocol> *)viewController
+{
+	if(self.observedViewControllers == nil) {
+		self.observedViewControllers = [NSHashTable weakObjectsHashTable];
+	}
+	
+	[viewController setVisiblePercentage:[self.stackViewController visiblePercentageForViewController:viewController]];
+	
+	if([self.observedViewControllers containsObject:viewController]) {
+		return;
+	}
+	
+	[self.observedViewControllers addObject:viewController];
+	
+	[self.stackViewController registerVisibilityObserverForViewController:viewController thresholds:@[@(0.0f), @(0.25f), @(0.5f), @(0.75f), @(1.0f)] handler:^(UIViewController *observedViewController, CGFloat threshold, CGFloat visiblePercentage) {
+		[(UIViewController<SCStackedViewControllerProtocol> *)observedViewController setVisiblePercentage:visiblePercentage];
+	}];
+}
+
+- (void)_registerLayouter:(id<SCStackLayouterProtocol>)layouter decoration:(SCStackDecoration *)decoration
 {
 	for(NSUInteger i=SCStackViewControllerPositionTop; i<=SCStackViewControllerPositionRight; i++) {
 		[self.stackViewController registerLayouter:layouter forPosition:(SCStackViewControllerPosition)i animated:NO];
+		[self.stackViewController registerDecoration:decoration forPosition:(SCStackViewControllerPosition)i];
 	}
 }
 
@@ -11,7 +11,6 @@
 #import "SCStackViewController.h"
 #import "SCStackNavigationStep.h"
 
-#import "UIView+Shadows.h"
 #import "UIColor+RandomColors.h"
 #import "SCTitleBarCollectionViewCell.h"
 
@@ -42,18 +41,11 @@
 - (void)viewDidLoad
 {
     [super viewDidLoad];
-    [self updateShadow];
 	
 	NSString *identifier =NSStringFromClass([SCTitleBarCollectionViewCell class]);
 	[self.collectionView registerNib:[UINib nibWithNibName:identifier bundle:nil] forCellWithReuseIdentifier:identifier];
 }
 
-- (void)viewWillLayoutSubviews
-{
-    [super viewWillLayoutSubviews];
-    [self updateShadow];
-}
-
 - (void)setVisiblePercentage:(CGFloat)percentage
 {
     [self.visiblePercentageLabel setText:[NSString stringWithFormat:@"%.3f%%", percentage]];
@@ -92,20 +84,4 @@
 	return cell;
 }
 
-- (void)updateShadow
-{
-	static NSDictionary *positionToShadowEdge;
-	static dispatch_once_t onceToken;
-	dispatch_once(&onceToken, ^{
-		positionToShadowEdge = (@{
-								  @(SCStackViewControllerPositionTop)    : @(SCShadowEdgeTop),
-								  @(SCStackViewControllerPositionLeft)   : @(SCShadowEdgeLeft),
-								  @(SCStackViewControllerPositionBottom) : @(SCShadowEdgeBottom),
-								  @(SCStackViewControllerPositionRight)  : @(SCShadowEdgeRight)
-								  });
-	});
-	
-	[self.view castShadowWithPosition:(SCShadowEdge)[positionToShadowEdge[@(self.position)] intValue]];
-}
-
 @end
@@ -0,0 +1,504 @@
+//
+//  SCStackViewControllerTests.m
+//  SCStackViewControllerTests
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+@import XCTest;
+@import ObjectiveC.runtime;
+
+#import <pthread.h>
+
+#import "SCStackViewController.h"
+#import "SCStackOcclusion.h"
+
+#import "SCStackLayouter.h"
+#import "SCParallaxStackLayouter.h"
+#import "SCSlidingStackLayouter.h"
+#import "SCResizingStackLayouter.h"
+#import "SCReversedStackLayouter.h"
+
+static const long kWorkloadSeed = 1337;
+static const NSUInteger kWorkloadOperationsCount = 200;
+static const NSUInteger kScrollGestureTicksCount = 8;
+
+static NSString *const kPushOperation = @"push";
+static NSString *const kPopOperation = @"pop";
+static NSString *const kNavigateOperation = @"navigate";
+static NSString *const kScrollTickOperation = @"scroll tick";
+
+static NSString *const kFinalFrameUpdatesMetric = @"final frame updates";
+static NSString *const kFrameUpdatesMetric = @"frame updates";
+static NSString *const kAllocationsMetric = @"allocations";
+
+// Every scale has 10 times more view controllers, linear costs per operation grow about as much while quadratic ones grow 100 times
+static const CGFloat kLinearGrowthBudget = 15.0f;
+static const CGFloat kConstantGrowthBudget = 3.0f;
+
+#pragma mark - Allocation counting
+
+static NSUInteger SCAllocationsCount = 0;
+static IMP SCOriginalAllocWithZone;
+
+// Only the main thread runs the workloads, whatever gets allocated in the background is noise
+static id SCCountingAllocWithZone(id self, SEL _cmd, struct _NSZone *zone)
+{
+	if(pthread_main_np()) {
+		SCAllocationsCount++;
+	}
+	
+	return ((id(*)(id, SEL, struct _NSZone *))SCOriginalAllocWithZone)(self, _cmd, zone);
+}
+
+#pragma mark - Stack internals
+
+@interface SCStackViewController (SCStackViewControllerTests)
+
+@property (nonatomic, strong) NSMutableArray *visibleControllers;
+
+@property (nonatomic, strong) NSMutableDictionary *finalFrames;
+@property (nonatomic, strong) NSMutableDictionary *stackIndexes;
+@property (nonatomic, strong) NSMutableDictionary *stackPositions;
+
+@property (nonatomic, strong) NSMutableDictionary *visiblePercentages;
+@property (nonatomic, assign) CGFloat rootVerticalVisiblePercentage;
+@property (nonatomic, assign) CGFloat rootHorizontalVisiblePercentage;
+
+@end
+
+#pragma mark - Tests
+
+@interface SCStackViewControllerTests : XCTestCase
+
+@property (nonatomic, strong) NSMutableDictionary *operationMetrics;
+@property (nonatomic, strong) NSCountedSet *operationCounts;
+
+@end
+
+@implementation SCStackViewControllerTests
+
+- (void)setUp
+{
+	[super setUp];
+	
+	// Replacing NSObject's implementation routes every +alloc through it, including the runtime's fast path
+	Method method = class_getClassMethod([NSObject class], @selector(allocWithZone:));
+	SCOriginalAllocWithZone = method_setImplementation(method, (IMP)SCCountingAllocWithZone);
+}
+
+- (void)tearDown
+{
+	Method method = class_getClassMethod([NSObject class], @selector(allocWithZone:));
+	method_setImplementation(method, SCOriginalAllocWithZone);
+	
+	[super tearDown];
+}
+
+- (void)testStackLayouterWorkloads
+{
+	[self runWorkloadsWithLayouterClass:[SCStackLayouter class] overlapping:NO];
+}
+
+- (void)testParallaxStackLayouterWorkloads
+{
+	[self runWorkloadsWithLayouterClass:[SCParallaxStackLayouter class] overlapping:YES];
+}
+
+- (void)testSlidingStackLayouterWorkloads
+{
+	[self runWorkloadsWithLayouterClass:[SCSlidingStackLayouter class] overlapping:YES];
+}
+
+- (void)testResizingStackLayouterWorkloads
+{
+	[self runWorkloadsWithLayouterClass:[SCResizingStackLayouter class] overlapping:NO];
+}
+
+- (void)testReversedStackLayouterWorkloads
+{
+	[self runWorkloadsWithLayouterClass:[SCReversedStackLayouter class] overlapping:YES];
+}
+
+- (void)testOcclusionMatchesBruteForce
+{
+	srand48(kWorkloadSeed);
+	
+	const CGFloat windowStart = 10.0f;
+	const CGFloat windowEnd = 90.0f;
+	
+	for(NSUInteger iteration = 0; iteration < 100; iteration++) {
+		
+		NSUInteger count = 1 + (NSUInteger)(lrand48() % 32);
+		SCStackOcclusionInterval *intervals = calloc(count, sizeof(SCStackOcclusionInterval));
+		
+		// Integer endpoints make unit cells exact, reversed intervals are allowed
+		for(NSUInteger i = 0; i < count; i++) {
+			intervals[i].start = (CGFloat)(lrand48() % 101);
+			intervals[i].end = (CGFloat)(lrand48() % 101);
+			intervals[i].zIndex = (NSInteger)i;
+		}
+		
+		SCStackOcclusionResolveIntervals(intervals, count, windowStart, windowEnd);
+		
+		CGFloat totalExposedLength = 0.0f;
+		for(NSUInteger i = 0; i < count; i++) {
+			
+			CGFloat expectedExposedLength = 0.0f;
+			for(NSInteger cell = (NSInteger)windowStart; cell < (NSInteger)windowEnd; cell++) {
+				
+				NSInteger topmost = -1;
+				for(NSUInteger j = 0; j < count; j++) {
+					CGFloat start = MIN(intervals[j].start, intervals[j].end);
+					CGFloat end = MAX(intervals[j].start, intervals[j].end);
+					
+					if(start <= cell && end >= cell + 1 && (topmost == -1 || intervals[j].zIndex > intervals[topmost].zIndex)) {
+						topmost = (NSInteger)j;
+					}
+				}
+				
+				if(topmost == (NSInteger)i) {
+					expectedExposedLength += 1.0f;
+				}
+			}
+			
+			XCTAssertEqualWithAccuracy(intervals[i].exposedLength, expectedExposedLength, 0.001f, @"Wrong exposed length for interval %lu", (unsigned long)i);
+			totalExposedLength += intervals[i].exposedLength;
+		}
+		
+		// Every elementary segment gets claimed at most once
+		XCTAssertLessThanOrEqual(totalExposedLength, windowEnd - windowStart + 0.001f, @"Exposed lengths exceed the visible window");
+		
+		free(intervals);
+	}
+}
+
+#pragma mark - Workloads
+
+- (void)runWorkloadsWithLayouterClass:(Class)layouterClass overlapping:(BOOL)overlapping
+{
+	NSDictionary *previousMetrics;
+	NSUInteger previousControllersCount = 0;
+	
+	for(NSNumber *controllersCount in @[@10, @100, @1000]) {
+		
+		NSDictionary *metrics = [self runWorkloadWithLayouterClass:layouterClass controllersCount:controllersCount.unsignedIntegerValue overlapping:overlapping];
+		
+		for(NSString *operation in metrics) {
+			if(previousMetrics[operation] == nil) {
+				continue;
+			}
+			
+			CGFloat growthBudget = [self growthBudgetForOperation:operation layouterClass:layouterClass];
+			
+			for(NSString *metric in metrics[operation]) {
+				CGFloat growth = [metrics[operation][metric] floatValue] / MAX([previousMetrics[operation][metric] floatValue], 1.0f);
+				XCTAssertLessThanOrEqual(growth, growthBudget, @"%@ %@ per %@ grew %.1fx going from %lu to %@ view controllers",
+										 NSStringFromClass(layouterClass), metric, operation, growth, (unsigned long)previousControllersCount, controllersCount);
+			}
+		}
+		
+		previousMetrics = metrics;
+		previousControllersCount = controllersCount.unsignedIntegerValue;
+	}
+}
+
+// Pushes and pops recalculate a whole position, scroll ticks only touch the view controllers around the visible bounds
+- (CGFloat)growthBudgetForOperation:(NSString *)operation layouterClass:(Class)layouterClass
+{
+	// Reversed layouters move the view controllers away from their final frames so every tick lays all of them out
+	if([operation isEqualToString:kScrollTickOperation] && ![layouterClass isSubclassOfClass:[SCReversedStackLayouter class]]) {
+		return kConstantGrowthBudget;
+	}
+	
+	return kLinearGrowthBudget;
+}
+
+// Returns the average cost of every operation type, keyed by operation and metric
+- (NSDictionary *)runWorkloadWithLayouterClass:(Class)layouterClass controllersCount:(NSUInteger)controllersCount overlapping:(BOOL)overlapping
+{
+	srand48(kWorkloadSeed + (long)controllersCount);
+	
+	SCStackViewController *stackViewController = [[SCStackViewController alloc] initWithRootViewController:[[UIViewController alloc] init]];
+	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
+		[stackViewController registerLayouter:[[layouterClass alloc] init] forPosition:position animated:NO];
+	}
+	
+	UIWindow *window = [[UIWindow alloc] initWithFrame:CGRectMake(0.0f, 0.0f, 1024.0f, 768.0f)];
+	[window setRootViewController:stackViewController];
+	[window makeKeyAndVisible];
+	
+	NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5.0];
+	while(!stackViewController.visible && [timeout timeIntervalSinceNow] > 0.0) {
+		[[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+	}
+	XCTAssertTrue(stackViewController.visible, @"The Stack never appeared");
+	
+	for(NSUInteger i = 0; i < controllersCount; i++) {
+		[self pushRandomViewControllerOnStackViewController:stackViewController];
+	}
+	
+	[self assertLayoutInvariantsOfStackViewController:stackViewController overlapping:overlapping];
+	
+	self.operationMetrics = [NSMutableDictionary dictionary];
+	self.operationCounts = [NSCountedSet set];
+	
+	for(NSUInteger i = 0; i < kWorkloadOperationsCount; i++) {
+		[self performRandomOperationOnStackViewController:stackViewController];
+		[self assertLayoutInvariantsOfStackViewController:stackViewController overlapping:overlapping];
+	}
+	
+	NSUInteger finalFrameUpdatesCount = 0;
+	
+	NSMutableDictionary *metrics = [NSMutableDictionary dictionary];
+	for(NSString *operation in self.operationMetrics) {
+		NSUInteger operationsCount = [self.operationCounts countForObject:operation];
+		finalFrameUpdatesCount += [self.operationMetrics[operation][kFinalFrameUpdatesMetric] unsignedIntegerValue];
+		
+		NSMutableDictionary *averages = [NSMutableDictionary dictionary];
+		for(NSString *metric in self.operationMetrics[operation]) {
+			averages[metric] = @([self.operationMetrics[operation][metric] floatValue] / operationsCount);
+		}
+		
+		metrics[operation] = averages;
+	}
+	
+	// Linear in the number of stacked view controllers at worst, each push or pop recalculates one position
+	NSUInteger maximumControllersCount = controllersCount + kWorkloadOperationsCount;
+	XCTAssertLessThanOrEqual(finalFrameUpdatesCount, kWorkloadOperationsCount * maximumControllersCount,
+							 @"%@ recalculated too many final frames with %lu view controllers", NSStringFromClass(layouterClass), (unsigned long)controllersCount);
+	
+	[window setHidden:YES];
+	[window setRootViewController:nil];
+	
+	return metrics;
+}
+
+- (void)performRandomOperationOnStackViewController:(SCStackViewController *)stackViewController
+{
+	NSMutableArray *viewControllers = [NSMutableArray array];
+	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
+		[viewControllers addObjectsFromArray:[stackViewController viewControllersForPosition:position]];
+	}
+	
+	UIViewController *randomViewController = (viewControllers.count ? viewControllers[(NSUInteger)lrand48() % viewControllers.count] : nil);
+	
+	switch (lrand48() % 4) {
+		case 0:
+		{
+			[self pushRandomViewControllerOnStackViewController:stackViewController];
+			break;
+		}
+		case 1:
+		{
+			if(randomViewController) {
+				[self measureOperation:kPopOperation onStackViewController:stackViewController usingBlock:^{
+					[stackViewController popViewController:randomViewController animated:NO completion:nil];
+				}];
+			}
+			break;
+		}
+		case 2:
+		{
+			if(randomViewController) {
+				[self measureOperation:kNavigateOperation onStackViewController:stackViewController usingBlock:^{
+					[stackViewController navigateToViewController:randomViewController animated:NO completion:nil];
+				}];
+			}
+			break;
+		}
+		default:
+		{
+			[self performRandomScrollGestureOnStackViewController:stackViewController];
+			break;
+		}
+	}
+}
+
+// Scrolls along a random axis to a random offset within the insets in a few ticks
+- (void)performRandomScrollGestureOnStackViewController:(SCStackViewController *)stackViewController
+{
+	UIEdgeInsets insets = stackViewController.scrollView.contentInset;
+	CGPoint startContentOffset = stackViewController.scrollView.contentOffset;
+	
+	BOOL isVertical = (lrand48() % 2);
+	
+	CGPoint targetContentOffset;
+	if(isVertical) {
+		startContentOffset.x = 0.0f;
+		targetContentOffset = CGPointMake(0.0f, -insets.top + (CGFloat)drand48() * (insets.top + insets.bottom));
+	} else {
+		startContentOffset.y = 0.0f;
+		targetContentOffset = CGPointMake(-insets.left + (CGFloat)drand48() * (insets.left + insets.right), 0.0f);
+	}
+	
+	// Switching axes lays out both of them once, the rest of the gesture is what scrolling costs
+	[stackViewController.scrollView setContentOffset:startContentOffset];
+	
+	for(NSUInteger tick = 1; tick <= kScrollGestureTicksCount; tick++) {
+		CGFloat progress = (CGFloat)tick / kScrollGestureTicksCount;
+		CGPoint contentOffset = CGPointMake(startContentOffset.x + (targetContentOffset.x - startContentOffset.x) * progress,
+											startContentOffset.y + (targetContentOffset.y - startContentOffset.y) * progress);
+		
+		[self measureOperation:kScrollTickOperation onStackViewController:stackViewController usingBlock:^{
+			[stackViewController.scrollView setContentOffset:contentOffset];
+		}];
+	}
+}
+
+// Size hints defer loading the views until they approach the visible bounds, which the workloads rely on at larger scales
+- (void)pushRandomViewControllerOnStackViewController:(SCStackViewController *)stackViewController
+{
+	SCStackViewControllerPosition position = (SCStackViewControllerPosition)(lrand48() % 4);
+	BOOL isVertical = (position == SCStackViewControllerPositionTop || position == SCStackViewControllerPositionBottom);
+	
+	// Zero dimensions in the size hints resolve to the Stack's own
+	CGFloat length = 128.0f + (CGFloat)(lrand48() % 256);
+	
+	UIViewController *viewController = [[UIViewController alloc] init];
+	[viewController setPreferredContentSize:(isVertical ? CGSizeMake(0.0f, length) : CGSizeMake(length, 0.0f))];
+	
+	[self measureOperation:kPushOperation onStackViewController:stackViewController usingBlock:^{
+		[stackViewController pushViewController:viewController atPosition:position unfold:NO animated:NO completion:nil];
+	}];
+}
+
+- (void)measureOperation:(NSString *)operation onStackViewController:(SCStackViewController *)stackViewController usingBlock:(void(^)(void))block
+{
+	NSUInteger allocationsCount = SCAllocationsCount;
+	NSUInteger finalFrameUpdatesCount = stackViewController.finalFrameUpdatesCount;
+	NSUInteger frameUpdatesCount = stackViewController.appliedFrameUpdatesCount + stackViewController.appliedSublayerTransformUpdatesCount;
+	
+	block();
+	
+	// Operations done while setting up the workload aren't measured
+	if(self.operationMetrics == nil) {
+		return;
+	}
+	
+	NSDictionary *costs = (@{kFinalFrameUpdatesMetric : @(stackViewController.finalFrameUpdatesCount - finalFrameUpdatesCount),
+							 kFrameUpdatesMetric      : @(stackViewController.appliedFrameUpdatesCount + stackViewController.appliedSublayerTransformUpdatesCount - frameUpdatesCount),
+							 kAllocationsMetric       : @(SCAllocationsCount - allocationsCount)});
+	
+	NSMutableDictionary *totals = self.operationMetrics[operation];
+	if(totals == nil) {
+		totals = [NSMutableDictionary dictionary];
+		self.operationMetrics[operation] = totals;
+	}
+	
+	for(NSString *metric in costs) {
+		totals[metric] = @([totals[metric] unsignedIntegerValue] + [costs[metric] unsignedIntegerValue]);
+	}
+	
+	[self.operationCounts addObject:operation];
+}
+
+#pragma mark - Invariants
+
+- (void)assertLayoutInvariantsOfStackViewController:(SCStackViewController *)stackViewController overlapping:(BOOL)overlapping
+{
+	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
+		NSArray *viewControllers = [stackViewController viewControllersForPosition:position];
+		
+		[viewControllers enumerateObjectsUsingBlock:^(UIViewController *viewController, NSUInteger idx, BOOL *stop) {
+			XCTAssertNotNil(stackViewController.finalFrames[@([viewController hash])], @"Stacked view controller without a final frame");
+			XCTAssertEqual([stackViewController.stackIndexes[@([viewController hash])] unsignedIntegerValue], idx, @"Stale stack index");
+			XCTAssertEqual([stackViewController.stackPositions[@([viewController hash])] unsignedIntegerValue], (NSUInteger)position, @"Stale stack position");
+			
+			CGFloat visiblePercentage = [stackViewController.visiblePercentages[@([viewController hash])] floatValue];
+			XCTAssertTrue(visiblePercentage >= 0.0f && visiblePercentage <= 1.0f + FLT_EPSILON, @"Visible percentage out of bounds");
+			
+			BOOL visible = (visiblePercentage > 0.0f && stackViewController.visible);
+			XCTAssertEqual(visible, [stackViewController.visibleControllers containsObject:viewController], @"Visibility out of sync with the visible percentage");
+		}];
+		
+		if(!overlapping) {
+			[self assertNoOverlapAtPosition:position ofStackViewController:stackViewController];
+		}
+	}
+	
+	for(UIViewController *viewController in stackViewController.visibleControllers) {
+		XCTAssertNotNil(stackViewController.stackIndexes[@([viewController hash])], @"Visible view controller isn't stacked");
+	}
+	
+	CGFloat rootPercentage = [stackViewController.visiblePercentages[@([stackViewController.rootViewController hash])] floatValue];
+	XCTAssertTrue(rootPercentage >= 0.0f && rootPercentage <= 1.0f + FLT_EPSILON, @"Root visible percentage out of bounds");
+	
+	[self assertVisiblePercentagesSumOfStackViewController:stackViewController verticalAxis:YES];
+	[self assertVisiblePercentagesSumOfStackViewController:stackViewController verticalAxis:NO];
+}
+
+// Every visible point along an axis belongs to exactly one view, so the exposed lengths add up to the length the views cover
+- (void)assertVisiblePercentagesSumOfStackViewController:(SCStackViewController *)stackViewController verticalAxis:(BOOL)isVertical
+{
+	CGRect bounds = stackViewController.scrollView.bounds;
+	CGFloat windowStart = (isVertical ? CGRectGetMinY(bounds) : CGRectGetMinX(bounds));
+	CGFloat windowEnd = (isVertical ? CGRectGetMaxY(bounds) : CGRectGetMaxX(bounds));
+	
+	NSMutableArray *viewControllers = [NSMutableArray array];
+	[viewControllers addObjectsFromArray:[stackViewController viewControllersForPosition:(isVertical ? SCStackViewControllerPositionTop : SCStackViewControllerPositionLeft)]];
+	[viewControllers addObjectsFromArray:[stackViewController viewControllersForPosition:(isVertical ? SCStackViewControllerPositionBottom : SCStackViewControllerPositionRight)]];
+	
+	UIViewController *rootViewController = stackViewController.rootViewController;
+	
+	CGFloat exposedLength = ((isVertical ? stackViewController.rootVerticalVisiblePercentage : stackViewController.rootHorizontalVisiblePercentage) *
+							 (isVertical ? CGRectGetHeight(rootViewController.view.frame) : CGRectGetWidth(rootViewController.view.frame)));
+	CGFloat accuracy = 0.001f * (windowEnd - windowStart);
+	
+	NSMutableArray *intervals = [NSMutableArray arrayWithObject:[NSValue valueWithCGPoint:(isVertical ? CGPointMake(CGRectGetMinY(rootViewController.view.frame), CGRectGetMaxY(rootViewController.view.frame))
+																					 : CGPointMake(CGRectGetMinX(rootViewController.view.frame), CGRectGetMaxX(rootViewController.view.frame)))]];
+	
+	for(UIViewController *viewController in viewControllers) {
+		if(!viewController.isViewLoaded || viewController.view.superview != stackViewController.scrollView) {
+			continue;
+		}
+		
+		CGRect frame = viewController.view.frame;
+		CGFloat length = (isVertical ? CGRectGetHeight(frame) : CGRectGetWidth(frame));
+		
+		exposedLength += [stackViewController.visiblePercentages[@([viewController hash])] floatValue] * length;
+		accuracy += 0.0005f * length;
+		
+		[intervals addObject:[NSValue valueWithCGPoint:(isVertical ? CGPointMake(CGRectGetMinY(frame), CGRectGetMaxY(frame)) : CGPointMake(CGRectGetMinX(frame), CGRectGetMaxX(frame)))]];
+	}
+	
+	[intervals sortUsingComparator:^NSComparisonResult(NSValue *first, NSValue *second) {
+		return [@([first CGPointValue].x) compare:@([second CGPointValue].x)];
+	}];
+	
+	// Length of the union of the views' extents within the visible bounds
+	CGFloat coveredLength = 0.0f;
+	CGFloat coveredEnd = windowStart;
+	for(NSValue *value in intervals) {
+		CGFloat start = MAX([value CGPointValue].x, coveredEnd);
+		CGFloat end = MIN([value CGPointValue].y, windowEnd);
+		
+		if(end > start) {
+			coveredLength += end - start;
+			coveredEnd = end;
+		}
+	}
+	
+	XCTAssertEqualWithAccuracy(exposedLength, coveredLength, accuracy, @"%@ visible percentages don't add up to the covered length", (isVertical ? @"Vertical" : @"Horizontal"));
+}
+
+// Consecutive view controllers on a position, and the first one and the root, only share edges
+- (void)assertNoOverlapAtPosition:(SCStackViewControllerPosition)position ofStackViewController:(SCStackViewController *)stackViewController
+{
+	UIViewController *previousViewController = stackViewController.rootViewController;
+	
+	for(UIViewController *viewController in [stackViewController viewControllersForPosition:position]) {
+		if(!viewController.isViewLoaded || viewController.view.superview != stackViewController.scrollView) {
+			continue;
+		}
+		
+		CGRect intersection = CGRectIntersection(previousViewController.view.frame, viewController.view.frame);
+		BOOL overlaps = (!CGRectIsNull(intersection) && CGRectGetWidth(intersection) > 0.5f && CGRectGetHeight(intersection) > 0.5f);
+		XCTAssertFalse(overlaps, @"View controller frames overlap at position %ld", (long)position);
+		
+		previousViewController = viewController;
+	}
+}
+
+@end
@@ -40,7 +40,7 @@
 		return finalFrame;
 	}
 	
-	CGRect frame = viewController.view.frame;
+	CGRect frame = finalFrame;
 	
 	switch (position) {
 		case SCStackViewControllerPositionTop: {
@@ -18,34 +18,30 @@
 						  withinGroup:(NSArray *)viewControllers
 					inStackController:(SCStackViewController *)stackController
 {
-	CGRect finalFrame =  viewController.view.frame;
+	CGRect finalFrame =  (CGRect){CGPointZero, [stackController sizeForViewController:viewController]};
 	switch (position) {
 		case SCStackViewControllerPositionTop: {
-			NSArray *previousViewControllers = [viewControllers subarrayWithRange:NSMakeRange(0, [viewControllers indexOfObject:viewController])];
-			CGFloat totalSize = [[viewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
+			CGFloat totalSize = [stackController summedSizeForViewControllersAtPosition:position].height;
 			
-			finalFrame.origin.y = - totalSize + [[previousViewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
+			finalFrame.origin.y = - totalSize + [stackController summedSizeForViewControllersAtPosition:position inRange:NSMakeRange(0, index)].height;
 			break;
 		}
 		case SCStackViewControllerPositionLeft: {
-			NSArray *previousViewControllers = [viewControllers subarrayWithRange:NSMakeRange(0, [viewControllers indexOfObject:viewController])];
-			CGFloat totalSize = [[viewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
+			CGFloat totalSize = [stackController summedSizeForViewControllersAtPosition:position].width;
 			
-			finalFrame.origin.x = - totalSize + [[previousViewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
+			finalFrame.origin.x = - totalSize + [stackController summedSizeForViewControllersAtPosition:position inRange:NSMakeRange(0, index)].width;
 			break;
 		}
 		case SCStackViewControllerPositionBottom: {
-			NSArray *previousViewControllers = [viewControllers subarrayWithRange:NSMakeRange(0, [viewControllers indexOfObject:viewController] + 1)];
-			CGFloat totalSize = [[viewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
+			CGFloat totalSize = [stackController summedSizeForViewControllersAtPosition:position].height;
 			
-			finalFrame.origin.y = CGRectGetHeight(stackController.view.bounds) + totalSize - [[previousViewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
+			finalFrame.origin.y = CGRectGetHeight(stackController.view.bounds) + totalSize - [stackController summedSizeForViewControllersAtPosition:position inRange:NSMakeRange(0, index + 1)].height;
 			break;
 		}
 		case SCStackViewControllerPositionRight: {
-			NSArray *previousViewControllers = [viewControllers subarrayWithRange:NSMakeRange(0, [viewControllers indexOfObject:viewController] + 1)];
-			CGFloat totalSize = [[viewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
+			CGFloat totalSize = [stackController summedSizeForViewControllersAtPosition:position].width;
 			
-			finalFrame.origin.x = CGRectGetWidth(stackController.view.bounds) + totalSize - [[previousViewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
+			finalFrame.origin.x = CGRectGetWidth(stackController.view.bounds) + totalSize - [stackController summedSizeForViewControllersAtPosition:position inRange:NSMakeRange(0, index + 1)].width;
 			break;
 		}
 		default:
@@ -62,36 +58,33 @@
 						  contentOffset:(CGPoint)contentOffset
 					  inStackController:(SCStackViewController *)stackController
 {
-	NSArray *viewControllers = [stackController viewControllersForPosition:position];
+	CGSize totalSize = [stackController summedSizeForViewControllersAtPosition:position];
+	CGSize firstSize = [stackController summedSizeForViewControllersAtPosition:position inRange:NSMakeRange(0, 1)];
 	
 	CGRect frame = finalFrame;
 	
 	switch (position) {
 		case SCStackViewControllerPositionTop:
 		{
-			CGFloat totalSize = [[viewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
-			frame.origin.y =  MIN(-CGRectGetHeight(((UIViewController*)viewControllers[0]).view.frame), finalFrame.origin.y + (totalSize + contentOffset.y));
+			frame.origin.y =  MIN(-firstSize.height, finalFrame.origin.y + (totalSize.height + contentOffset.y));
 			frame.size.width = CGRectGetWidth(stackController.view.bounds);
 			break;
 		}
 		case SCStackViewControllerPositionLeft:
 		{
-			CGFloat totalSize = [[viewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
-			frame.origin.x =  MIN(-CGRectGetWidth(((UIViewController*)viewControllers[0]).view.frame), finalFrame.origin.x + (totalSize + contentOffset.x));
+			frame.origin.x =  MIN(-firstSize.width, finalFrame.origin.x + (totalSize.width + contentOffset.x));
 			frame.size.height = CGRectGetHeight(stackController.view.bounds);
 			break;
 		}
 		case SCStackViewControllerPositionBottom:
 		{
-			CGFloat totalSize = [[viewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
-			frame.origin.y = MAX(CGRectGetMaxY(stackController.view.bounds), CGRectGetMinY(finalFrame) - (totalSize - contentOffset.y));
+			frame.origin.y = MAX(CGRectGetMaxY(stackController.view.bounds), CGRectGetMinY(finalFrame) - (totalSize.height - contentOffset.y));
 			frame.size.width = CGRectGetWidth(stackController.view.bounds);
 			break;
 		}
 		case SCStackViewControllerPositionRight:
 		{
-			CGFloat totalSize = [[viewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
-			frame.origin.x = MAX(CGRectGetMaxX(stackController.view.bounds), CGRectGetMinX(finalFrame) - (totalSize - contentOffset.x));
+			frame.origin.x = MAX(CGRectGetMaxX(stackController.view.bounds), CGRectGetMinX(finalFrame) - (totalSize.width - contentOffset.x));
 			frame.size.height = CGRectGetHeight(stackController.view.bounds);
 			break;
 		}
@@ -18,24 +18,24 @@
 						  withinGroup:(NSArray *)viewControllers
 					inStackController:(SCStackViewController *)stackController
 {
-	viewControllers = [viewControllers subarrayWithRange:NSMakeRange(0, [viewControllers indexOfObject:viewController] + 1)];
+	CGSize summedSize = [stackController summedSizeForViewControllersAtPosition:position inRange:NSMakeRange(0, index + 1)];
 	
-	CGRect finalFrame =  viewController.view.frame;
+	CGRect finalFrame =  (CGRect){CGPointZero, [stackController sizeForViewController:viewController]};
 	switch (position) {
 		case SCStackViewControllerPositionTop: {
-			finalFrame.origin.y = - [[viewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
+			finalFrame.origin.y = - summedSize.height;
 			break;
 		}
 		case SCStackViewControllerPositionLeft: {
-			finalFrame.origin.x = - [[viewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
+			finalFrame.origin.x = - summedSize.width;
 			break;
 		}
 		case SCStackViewControllerPositionBottom: {
-			finalFrame.origin.y = CGRectGetHeight(stackController.view.bounds) + [[viewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue] - finalFrame.size.height;
+			finalFrame.origin.y = CGRectGetHeight(stackController.view.bounds) + summedSize.height - finalFrame.size.height;
 			break;
 		}
 		case SCStackViewControllerPositionRight: {
-			finalFrame.origin.x = CGRectGetWidth(stackController.view.bounds) + [[viewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue] - finalFrame.size.width;
+			finalFrame.origin.x = CGRectGetWidth(stackController.view.bounds) + summedSize.width - finalFrame.size.width;
 			break;
 		}
 		default:
@@ -55,19 +55,15 @@
 	switch (position) {
 		case SCStackViewControllerPositionTop:
 			finalFrame.size.width = CGRectGetWidth(stackController.view.bounds);
-			finalFrame.size.height = CGRectGetHeight(viewController.view.bounds);
 			break;
 		case SCStackViewControllerPositionLeft:
 			finalFrame.size.height = CGRectGetHeight(stackController.view.bounds);
-			finalFrame.size.width = CGRectGetWidth(viewController.view.bounds);
 			break;
 		case SCStackViewControllerPositionBottom:
 			finalFrame.size.width = CGRectGetWidth(stackController.view.bounds);
-			finalFrame.size.height = CGRectGetHeight(viewController.view.bounds);
 			break;
 		case SCStackViewControllerPositionRight:
 			finalFrame.size.height = CGRectGetHeight(stackController.view.bounds);
-			finalFrame.size.width = CGRectGetWidth(viewController.view.bounds);
 			break;
 		default:
 			break;
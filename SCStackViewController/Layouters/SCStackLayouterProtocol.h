@@ -12,6 +12,17 @@
  * the itermediate and final frames for the Stack's children when called. They
  * have access the the actual children so that they can customize the navigation
  * effects at each point of the transition.
+ *
+ * Sizes should be fetched through the Stack's sizeForViewController: (or
+ * sc_viewWidth/sc_viewHeight) instead of the children's views so that the
+ * latter don't have to be loaded before they're needed. Offsets depending on
+ * the view controllers before or after the current one should use the Stack's
+ * summedSizeForViewControllersAtPosition:inRange:, summing them up for every
+ * view controller makes laying out a position quadratic.
+ *
+ * Unless reversed, layouters should keep the current frames within one Stack
+ * viewport of the final ones. While scrolling, view controllers whose final
+ * frames are further away from the visible bounds aren't laid out.
  */
 
 @protocol SCStackLayouterProtocol <NSObject>
@@ -0,0 +1,80 @@
+//
+//  SCStackDecoration.h
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "SCStackViewController.h"
+
+/** Describes the edge shadow and dimming overlay the Stack draws on the view
+ * controllers stacked on a position
+ *
+ * Both are driven by each view controller's visible percentage: the shadow
+ * fades in as the view controller gets revealed while the dimming overlay
+ * fades out. Shadow paths are cached by size and shared between all the view
+ * controllers of the same size, layout passes only update opacities.
+ *
+ * Decorations should be configured before being registered with a Stack.
+ */
+@interface SCStackDecoration : NSObject
+
+/** Opacity of the edge shadow when the view controller is fully visible, 0 disables it
+ *
+ * Default value is set to 0.25f
+ */
+@property (nonatomic, assign) CGFloat shadowOpacity;
+
+
+/** Blur radius of the edge shadow
+ *
+ * Default value is set to 5.0f
+ */
+@property (nonatomic, assign) CGFloat shadowRadius;
+
+
+/** How far the shadow extends past the edge facing the root
+ *
+ * Default value is set to 10.0f
+ */
+@property (nonatomic, assign) CGFloat shadowExtent;
+
+
+/** Color of the edge shadow
+ *
+ * Default value is set to black
+ */
+@property (nonatomic, strong, nonnull) UIColor *shadowColor;
+
+
+/** Opacity of the dimming overlay when the view controller is fully hidden, 0 disables it
+ *
+ * Default value is set to 0.0f
+ */
+@property (nonatomic, assign) CGFloat maximumDimmingOpacity;
+
+
+/** Color of the dimming overlay
+ *
+ * Default value is set to black
+ */
+@property (nonatomic, strong, nonnull) UIColor *dimmingColor;
+
+
+/** Returns the shadow path for a view controller of the given size
+ *
+ * Paths are cached and shared between all the callers asking for the same
+ * size, position and extent. The cache owns them and only releases them on
+ * memory warnings, retain the path to keep it past the current run loop turn.
+ * Main thread only.
+ *
+ * @param size The view controller's size
+ * @param position The position the view controller is stacked on
+ * @param extent How far the shadow extends past the edge facing the root
+ */
++ (nonnull CGPathRef)shadowPathForSize:(CGSize)size
+							  position:(SCStackViewControllerPosition)position
+								extent:(CGFloat)extent;
+
+@end
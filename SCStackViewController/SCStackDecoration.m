@@ -0,0 +1,88 @@
+//
+//  SCStackDecoration.m
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "SCStackDecoration.h"
+
+@implementation SCStackDecoration
+
+- (instancetype)init
+{
+	if(self = [super init]) {
+		self.shadowOpacity = 0.25f;
+		self.shadowRadius = 5.0f;
+		self.shadowExtent = 10.0f;
+		self.shadowColor = [UIColor blackColor];
+		
+		self.maximumDimmingOpacity = 0.0f;
+		self.dimmingColor = [UIColor blackColor];
+	}
+	
+	return self;
+}
+
+typedef struct {
+	CGSize size;
+	NSUInteger position;
+	CGFloat extent;
+} SCStackShadowPathKey;
+
++ (CGPathRef)shadowPathForSize:(CGSize)size
+					  position:(SCStackViewControllerPosition)position
+						extent:(CGFloat)extent
+{
+	NSAssert([NSThread isMainThread], @"Shadow paths can only be requested from the main thread");
+	
+	// Unlike NSCache the dictionary never drops a path on its own, it only gets cleared between layout passes
+	static NSMutableDictionary *shadowPaths;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		shadowPaths = [NSMutableDictionary dictionary];
+		[[NSNotificationCenter defaultCenter] addObserverForName:UIApplicationDidReceiveMemoryWarningNotification object:nil queue:[NSOperationQueue mainQueue] usingBlock:^(NSNotification *notification) {
+			[shadowPaths removeAllObjects];
+		}];
+	});
+	
+	SCStackShadowPathKey keyValue;
+	memset(&keyValue, 0, sizeof(keyValue));
+	keyValue.size = size;
+	keyValue.position = position;
+	keyValue.extent = extent;
+	
+	NSValue *key = [NSValue valueWithBytes:&keyValue objCType:@encode(SCStackShadowPathKey)];
+	
+	id shadowPath = shadowPaths[key];
+	if(shadowPath) {
+		return (__bridge CGPathRef)shadowPath;
+	}
+	
+	// Extend the shadow past the edge facing the root
+	CGRect shadowRect = (CGRect){CGPointZero, size};
+	switch (position) {
+		case SCStackViewControllerPositionTop:
+			shadowRect.size.height += extent;
+			break;
+		case SCStackViewControllerPositionLeft:
+			shadowRect.size.width += extent;
+			break;
+		case SCStackViewControllerPositionBottom:
+			shadowRect.origin.y -= extent;
+			shadowRect.size.height += extent;
+			break;
+		case SCStackViewControllerPositionRight:
+			shadowRect.origin.x -= extent;
+			shadowRect.size.width += extent;
+			break;
+	}
+	
+	CGPathRef path = CGPathCreateWithRect(shadowRect, NULL);
+	[shadowPaths setObject:(__bridge_transfer id)path forKey:key];
+	
+	return path;
+}
+
+@end
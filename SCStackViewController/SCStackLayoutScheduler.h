@@ -0,0 +1,39 @@
+//
+//  SCStackLayoutScheduler.h
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+/** Coordinates the layout passes of nested Stacks.
+ *
+ * Stacks embedded in another Stack's child view controllers schedule their
+ * layout passes here instead of running them whenever their size changes.
+ * Scheduled passes run at most once per display frame and always parent
+ * first, either at the end of the enclosing Stack's own pass or on the next
+ * display tick for Stacks nested in other containers.
+ */
+
+@import UIKit;
+
+@class SCStackViewController;
+
+@interface SCStackLayoutScheduler : NSObject
+
+/** Returns the scheduler shared by all the Stacks */
++ (instancetype)sharedScheduler;
+
+/** Schedules a layout pass for the given Stack, multiple calls within the same frame get coalesced
+ *
+ * @param stackViewController The Stack that needs laying out
+ */
+- (void)scheduleLayoutForStackViewController:(SCStackViewController *)stackViewController;
+
+/** Runs the scheduled passes of the Stacks nested within the given one, parent first
+ *
+ * @param stackViewController The enclosing Stack, nil to run all the scheduled passes
+ */
+- (void)performScheduledLayoutsNestedInStackViewController:(SCStackViewController *)stackViewController;
+
+@end
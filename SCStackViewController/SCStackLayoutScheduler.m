@@ -0,0 +1,129 @@
+//
+//  SCStackLayoutScheduler.m
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "SCStackLayoutScheduler.h"
+#import "SCStackViewController.h"
+
+@interface SCStackViewController (SCStackLayoutScheduler)
+
+- (void)performScheduledLayout;
+
+@end
+
+@interface SCStackLayoutScheduler ()
+
+@property (nonatomic, strong) NSHashTable *scheduledStackViewControllers;
+
+@property (nonatomic, strong) CADisplayLink *displayLink;
+
+@end
+
+@implementation SCStackLayoutScheduler
+
++ (instancetype)sharedScheduler
+{
+	static SCStackLayoutScheduler *sharedScheduler;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedScheduler = [[SCStackLayoutScheduler alloc] init];
+	});
+	
+	return sharedScheduler;
+}
+
+- (instancetype)init
+{
+	if(self = [super init]) {
+		self.scheduledStackViewControllers = [NSHashTable weakObjectsHashTable];
+	}
+	
+	return self;
+}
+
+- (void)scheduleLayoutForStackViewController:(SCStackViewController *)stackViewController
+{
+	NSAssert([NSThread isMainThread], @"Layout passes can only be scheduled from the main thread");
+	
+	[self.scheduledStackViewControllers addObject:stackViewController];
+	
+	if(self.displayLink == nil) {
+		self.displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(onDisplayLinkTick:)];
+		[self.displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+	}
+}
+
+- (void)performScheduledLayoutsNestedInStackViewController:(SCStackViewController *)stackViewController
+{
+	// The display link only runs while passes are scheduled, every Stack's pass goes through here
+	if(self.displayLink == nil) {
+		return;
+	}
+	
+	// Weak tables keep counting deallocated entries until they get compacted, only the live ones matter
+	if(self.scheduledStackViewControllers.anyObject == nil) {
+		[self.displayLink invalidate];
+		self.displayLink = nil;
+		return;
+	}
+	
+	NSMutableArray *stackViewControllers;
+	NSMutableDictionary *depths;
+	
+	for(SCStackViewController *scheduledStackViewController in self.scheduledStackViewControllers) {
+		
+		// Depths are relative to the caller, walking up stops as soon as it's reached
+		NSUInteger depth = 0;
+		BOOL isNested = (stackViewController == nil);
+		
+		SCStackViewController *ancestor = scheduledStackViewController;
+		while((ancestor = ancestor.sc_stackViewController)) {
+			depth++;
+			
+			if(ancestor == stackViewController) {
+				isNested = YES;
+				break;
+			}
+		}
+		
+		if(!isNested) {
+			continue;
+		}
+		
+		if(stackViewControllers == nil) {
+			stackViewControllers = [NSMutableArray array];
+			depths = [NSMutableDictionary dictionary];
+		}
+		
+		[stackViewControllers addObject:scheduledStackViewController];
+		depths[@([scheduledStackViewController hash])] = @(depth);
+	}
+	
+	// Parents first, their passes might resize the Stacks nested within them
+	[stackViewControllers sortUsingComparator:^NSComparisonResult(SCStackViewController *first, SCStackViewController *second) {
+		return [depths[@([first hash])] compare:depths[@([second hash])]];
+	}];
+	
+	for(SCStackViewController *scheduledStackViewController in stackViewControllers) {
+		[self.scheduledStackViewControllers removeObject:scheduledStackViewController];
+		[scheduledStackViewController performScheduledLayout];
+	}
+	
+	if(self.scheduledStackViewControllers.anyObject == nil) {
+		[self.displayLink invalidate];
+		self.displayLink = nil;
+	}
+}
+
+#pragma mark - Private
+
+- (void)onDisplayLinkTick:(CADisplayLink *)displayLink
+{
+	[self performScheduledLayoutsNestedInStackViewController:nil];
+}
+
+@end
@@ -0,0 +1,35 @@
+//
+//  SCStackOcclusion.h
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+/** One dimensional occlusion resolution used by the Stack to calculate how
+ * much of each child is exposed along a scrolling axis.
+ *
+ * Each interval describes a view's extent along the axis and its z-order
+ * (higher values are drawn on top). Overlapping intervals are resolved
+ * topmost first in a single sorted sweep, so the cost is O(n log n)
+ * regardless of the layout the intervals come from.
+ */
+
+@import Foundation;
+@import CoreGraphics;
+
+typedef struct {
+	CGFloat start;			/** Start of the view's extent along the axis */
+	CGFloat end;			/** End of the view's extent along the axis */
+	NSInteger zIndex;		/** Views with higher values are on top */
+	CGFloat exposedLength;	/** Output: the length left unobstructed within the window */
+} SCStackOcclusionInterval;
+
+/** Calculates the exposed length of every interval within the given window
+ *
+ * @param intervals The intervals to resolve, their exposedLength gets filled in
+ * @param count The number of intervals
+ * @param windowStart Start of the visible window along the axis
+ * @param windowEnd End of the visible window along the axis
+ */
+void SCStackOcclusionResolveIntervals(SCStackOcclusionInterval *intervals, NSUInteger count, CGFloat windowStart, CGFloat windowEnd);
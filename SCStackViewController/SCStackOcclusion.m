@@ -0,0 +1,121 @@
+//
+//  SCStackOcclusion.m
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "SCStackOcclusion.h"
+
+static int SCStackOcclusionCompareCoordinates(const void *first, const void *second)
+{
+	CGFloat a = *(const CGFloat *)first;
+	CGFloat b = *(const CGFloat *)second;
+	
+	return (a > b) - (a < b);
+}
+
+static int SCStackOcclusionCompareDepths(void *intervals, const void *first, const void *second)
+{
+	NSInteger a = ((SCStackOcclusionInterval *)intervals)[*(const NSUInteger *)first].zIndex;
+	NSInteger b = ((SCStackOcclusionInterval *)intervals)[*(const NSUInteger *)second].zIndex;
+	
+	// Topmost first
+	return (a < b) - (a > b);
+}
+
+static NSUInteger SCStackOcclusionIndexOfCoordinate(CGFloat *coordinates, NSUInteger count, CGFloat coordinate)
+{
+	NSUInteger low = 0, high = count;
+	while(low < high) {
+		NSUInteger middle = (low + high) / 2;
+		if(coordinates[middle] < coordinate) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	
+	return low;
+}
+
+// Returns the first uncovered elementary segment at or after the given one, compressing the path along the way
+static NSUInteger SCStackOcclusionNextUncoveredSegment(NSUInteger *nextUncovered, NSUInteger segment)
+{
+	NSUInteger root = segment;
+	while(nextUncovered[root] != root) {
+		root = nextUncovered[root];
+	}
+	
+	while(nextUncovered[segment] != root) {
+		NSUInteger next = nextUncovered[segment];
+		nextUncovered[segment] = root;
+		segment = next;
+	}
+	
+	return root;
+}
+
+void SCStackOcclusionResolveIntervals(SCStackOcclusionInterval *intervals, NSUInteger count, CGFloat windowStart, CGFloat windowEnd)
+{
+	if(count == 0) {
+		return;
+	}
+	
+	CGFloat *coordinates = malloc(sizeof(CGFloat) * 2 * count);
+	NSUInteger *order = malloc(sizeof(NSUInteger) * count);
+	NSUInteger *nextUncovered = malloc(sizeof(NSUInteger) * 2 * count);
+	
+	// Clip everything to the window and compress the endpoints into elementary segments
+	NSUInteger coordinatesCount = 0;
+	for(NSUInteger i = 0; i < count; i++) {
+		intervals[i].exposedLength = 0.0f;
+		order[i] = i;
+		
+		coordinates[coordinatesCount++] = MIN(MAX(MIN(intervals[i].start, intervals[i].end), windowStart), windowEnd);
+		coordinates[coordinatesCount++] = MIN(MAX(MAX(intervals[i].start, intervals[i].end), windowStart), windowEnd);
+	}
+	
+	qsort(coordinates, coordinatesCount, sizeof(CGFloat), SCStackOcclusionCompareCoordinates);
+	
+	NSUInteger uniqueCount = 0;
+	for(NSUInteger i = 0; i < coordinatesCount; i++) {
+		if(uniqueCount == 0 || coordinates[i] != coordinates[uniqueCount - 1]) {
+			coordinates[uniqueCount++] = coordinates[i];
+		}
+	}
+	
+	// Segment i spans [coordinates[i], coordinates[i + 1]], the last index is a sentinel
+	for(NSUInteger i = 0; i < uniqueCount; i++) {
+		nextUncovered[i] = i;
+	}
+	
+	qsort_r(order, count, sizeof(NSUInteger), intervals, SCStackOcclusionCompareDepths);
+	
+	// Paint the intervals topmost first, every elementary segment gets claimed by exactly one of them
+	for(NSUInteger i = 0; i < count; i++) {
+		SCStackOcclusionInterval *interval = &intervals[order[i]];
+		
+		CGFloat start = MIN(MAX(MIN(interval->start, interval->end), windowStart), windowEnd);
+		CGFloat end = MIN(MAX(MAX(interval->start, interval->end), windowStart), windowEnd);
+		
+		if(end <= start) {
+			continue;
+		}
+		
+		NSUInteger firstSegment = SCStackOcclusionIndexOfCoordinate(coordinates, uniqueCount, start);
+		NSUInteger lastSegment = SCStackOcclusionIndexOfCoordinate(coordinates, uniqueCount, end);
+		
+		NSUInteger segment = SCStackOcclusionNextUncoveredSegment(nextUncovered, firstSegment);
+		while(segment < lastSegment) {
+			interval->exposedLength += coordinates[segment + 1] - coordinates[segment];
+			nextUncovered[segment] = segment + 1;
+			segment = SCStackOcclusionNextUncoveredSegment(nextUncovered, segment + 1);
+		}
+	}
+	
+	free(coordinates);
+	free(order);
+	free(nextUncovered);
+}
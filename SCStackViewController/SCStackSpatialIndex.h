@@ -0,0 +1,51 @@
+//
+//  SCStackSpatialIndex.h
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+/** A uniform grid over object frames used by the Stack to find the view
+ * controllers around a point or rect without going through all of them.
+ *
+ * Every object is registered in the cells its frame overlaps so queries only
+ * touch the cells covering the query rect. With a cell size in the order of the
+ * Stack's bounds that is proportional to the number of frames near the query.
+ *
+ * Objects are held weakly and drop out of the index once deallocated.
+ */
+
+@import Foundation;
+@import CoreGraphics;
+
+@interface SCStackSpatialIndex : NSObject
+
+/** Creates and returns a new index
+ *
+ * @param cellSize The size of the grid's cells
+ */
+- (nonnull instancetype)initWithCellSize:(CGSize)cellSize;
+
+/** The size of the grid's cells */
+@property (nonatomic, readonly) CGSize cellSize;
+
+/** Adds the object or moves it to the given frame if already indexed */
+- (void)setFrame:(CGRect)frame forObject:(nonnull id)object;
+
+/** Removes the object from the index */
+- (void)removeObject:(nonnull id)object;
+
+/** Removes all the objects from the index */
+- (void)removeAllObjects;
+
+/** Enumerates the objects whose frames intersect the given rect, every object
+ * is visited at most once and in no particular order
+ *
+ * @param rect The rect to search in. Empty rects match the frames containing
+ * their origin.
+ * @param block Block called for every matching object
+ */
+- (void)enumerateObjectsIntersectingRect:(CGRect)rect usingBlock:(nonnull void(^)(id __nonnull object, CGRect frame, BOOL * __nonnull stop))block;
+
+@end
@@ -0,0 +1,144 @@
+//
+//  SCStackSpatialIndex.m
+//  SCStackViewController
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "SCStackSpatialIndex.h"
+
+@interface SCStackSpatialIndex ()
+
+@property (nonatomic, assign) CGSize cellSize;
+
+@property (nonatomic, strong) NSMutableDictionary *cells;
+@property (nonatomic, strong) NSMapTable *frames;
+
+@end
+
+@implementation SCStackSpatialIndex
+
+- (instancetype)initWithCellSize:(CGSize)cellSize
+{
+	if(self = [super init]) {
+		self.cellSize = CGSizeMake(MAX(cellSize.width, 1.0f), MAX(cellSize.height, 1.0f));
+		self.cells = [NSMutableDictionary dictionary];
+		self.frames = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+											valueOptions:NSPointerFunctionsStrongMemory];
+	}
+	
+	return self;
+}
+
+- (void)setFrame:(CGRect)frame forObject:(id)object
+{
+	[self removeObject:object];
+	
+	frame = CGRectStandardize(frame);
+	[self.frames setObject:[NSValue valueWithCGRect:frame] forKey:object];
+	
+	[self enumerateCellsInRect:frame usingBlock:^(NSInteger column, NSInteger row, BOOL *stop) {
+		NSNumber *key = [self keyForColumn:column row:row];
+		
+		NSHashTable *objects = self.cells[key];
+		if(objects == nil) {
+			objects = [NSHashTable hashTableWithOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality];
+			[self.cells setObject:objects forKey:key];
+		}
+		
+		[objects addObject:object];
+	}];
+}
+
+- (void)removeObject:(id)object
+{
+	NSValue *value = [self.frames objectForKey:object];
+	if(value == nil) {
+		return;
+	}
+	
+	[self enumerateCellsInRect:[value CGRectValue] usingBlock:^(NSInteger column, NSInteger row, BOOL *stop) {
+		NSNumber *key = [self keyForColumn:column row:row];
+		
+		NSHashTable *objects = self.cells[key];
+		[objects removeObject:object];
+		
+		if(objects.anyObject == nil) {
+			[self.cells removeObjectForKey:key];
+		}
+	}];
+	
+	[self.frames removeObjectForKey:object];
+}
+
+- (void)removeAllObjects
+{
+	[self.cells removeAllObjects];
+	[self.frames removeAllObjects];
+}
+
+- (void)enumerateObjectsIntersectingRect:(CGRect)rect usingBlock:(void(^)(id object, CGRect frame, BOOL *stop))block
+{
+	rect = CGRectStandardize(rect);
+	
+	NSInteger firstColumn = [self columnForX:CGRectGetMinX(rect)];
+	NSInteger firstRow = [self rowForY:CGRectGetMinY(rect)];
+	
+	[self enumerateCellsInRect:rect usingBlock:^(NSInteger column, NSInteger row, BOOL *stopCells) {
+		for(id object in self.cells[[self keyForColumn:column row:row]]) {
+			
+			CGRect frame = [[self.frames objectForKey:object] CGRectValue];
+			
+			// Only report an object in the first cell both it and the rect cover so that it's visited once
+			if(column != MAX(firstColumn, [self columnForX:CGRectGetMinX(frame)]) || row != MAX(firstRow, [self rowForY:CGRectGetMinY(frame)])) {
+				continue;
+			}
+			
+			BOOL intersects = (CGRectIsEmpty(rect) ? CGRectContainsPoint(frame, rect.origin) : CGRectIntersectsRect(frame, rect));
+			if(!intersects) {
+				continue;
+			}
+			
+			block(object, frame, stopCells);
+			if(*stopCells) {
+				return;
+			}
+		}
+	}];
+}
+
+#pragma mark - Private
+
+- (void)enumerateCellsInRect:(CGRect)rect usingBlock:(void(^)(NSInteger column, NSInteger row, BOOL *stop))block
+{
+	NSInteger lastColumn = MAX([self columnForX:CGRectGetMaxX(rect)], [self columnForX:CGRectGetMinX(rect)]);
+	NSInteger lastRow = MAX([self rowForY:CGRectGetMaxY(rect)], [self rowForY:CGRectGetMinY(rect)]);
+	
+	BOOL stop = NO;
+	for(NSInteger row = [self rowForY:CGRectGetMinY(rect)]; row <= lastRow; row++) {
+		for(NSInteger column = [self columnForX:CGRectGetMinX(rect)]; column <= lastColumn; column++) {
+			block(column, row, &stop);
+			if(stop) {
+				return;
+			}
+		}
+	}
+}
+
+- (NSInteger)columnForX:(CGFloat)x
+{
+	return (NSInteger)floor(x / self.cellSize.width);
+}
+
+- (NSInteger)rowForY:(CGFloat)y
+{
+	return (NSInteger)floor(y / self.cellSize.height);
+}
+
+- (NSNumber *)keyForColumn:(NSInteger)column row:(NSInteger)row
+{
+	return @(((int64_t)(int32_t)column << 32) | (uint32_t)(int32_t)row);
+}
+
+@end
@@ -26,6 +26,16 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
 };
 
 
+/** Policies deciding which axis a gesture starting on the root moves along
+ * when view controllers are stacked both vertically and horizontally
+ */
+typedef NS_ENUM(NSUInteger, SCStackViewControllerAxisLockingPolicy) {
+	SCStackViewControllerAxisLockingPolicyDominantVelocity,   /** The axis with the higher velocity wins, ties go to the vertical one */
+	SCStackViewControllerAxisLockingPolicyPreferVertical,     /** Any vertical movement locks the vertical axis */
+	SCStackViewControllerAxisLockingPolicyPreferHorizontal    /** Any horizontal movement locks the horizontal axis */
+};
+
+
 @protocol SCStackLayouterProtocol;
 @protocol SCEasingFunctionProtocol;
 
@@ -34,14 +44,18 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
 @class SCScrollView;
 
 @class SCStackNavigationStep;
+@class SCStackDecoration;
 
 /** SCStackViewController is a container view controller which allows you to
  * stack other view controllers on the top/left/bottom/right of the root and
  * build custom transitions between them while providing correct physics and
  * appearance calls.
  *
- * @warning One should not attempt to use the stack with both vertical and
- * horizontal layouters at the same time. The behavior is undefined.
+ * View controllers can be stacked both vertically and horizontally at the
+ * same time. The Stack only moves along one axis at a time: layouters get the
+ * content offset along their own axis, gestures starting on the root get
+ * locked to an axis based on the axisLockingPolicy and programmatic navigation
+ * between axes goes through the root.
  */
 
 @interface SCStackViewController : UIViewController
@@ -102,6 +116,34 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
 @property (nonatomic, assign) NSTimeInterval animationDuration;
 
 
+/** A Boolean value that determines whether push/pop/navigate animations are
+ * handed over to Core Animation
+ *
+ * When enabled the layouters and the easing function are sampled up front and
+ * the resulting frames and sublayer transforms are submitted as keyframe
+ * animations, which the render server runs independently of the main thread's
+ * load. Scrolling is disabled while such an animation runs, the offset delegate
+ * calls are skipped and the appearance callbacks are triggered when it
+ * completes.
+ *
+ * The content offset and the children's frames are moved to their final values
+ * as soon as the animation starts so hit testing reflects the destination.
+ * Visibility observers, edge decorations and the visibleViewControllers list
+ * keep describing the starting state until the animation completes.
+ *
+ * Default value is set to false
+ */
+@property (nonatomic, assign) BOOL keyframeAnimationsEnabled;
+
+
+/** Decides the axis diagonal gestures starting on the root get locked to when
+ * view controllers are stacked both vertically and horizontally
+ *
+ * Default value is set to SCStackViewControllerAxisLockingPolicyDominantVelocity
+ */
+@property (nonatomic, assign) SCStackViewControllerAxisLockingPolicy axisLockingPolicy;
+
+
 /** The stack's internal scroll view */
 @property (nonatomic, strong, nonnull, readonly) SCScrollView *scrollView;
 
@@ -117,6 +159,34 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
 @property (nonatomic, readonly) BOOL visible;
 
 
+/**-----------------------------------------------------------------------------
+ * @name Layout statistics
+ * -----------------------------------------------------------------------------
+ */
+
+/** Number of view frame writes done by the Stack */
+@property (nonatomic, readonly) NSUInteger appliedFrameUpdatesCount;
+
+/** Number of view frame writes skipped because the frame didn't change */
+@property (nonatomic, readonly) NSUInteger skippedFrameUpdatesCount;
+
+/** Number of sublayer transform writes done by the Stack */
+@property (nonatomic, readonly) NSUInteger appliedSublayerTransformUpdatesCount;
+
+/** Number of sublayer transform writes skipped because the transform didn't
+ * change
+ */
+@property (nonatomic, readonly) NSUInteger skippedSublayerTransformUpdatesCount;
+
+/** Number of final frames requested from the layouters, grows linearly with
+ * the number of view controllers on a position for every push and pop
+ */
+@property (nonatomic, readonly) NSUInteger finalFrameUpdatesCount;
+
+/** Resets all the layout statistics counters to 0 */
+- (void)resetLayoutStatistics;
+
+
 /**-----------------------------------------------------------------------------
  * @name Initializing the Stack
  * -----------------------------------------------------------------------------
@@ -166,6 +236,25 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
 - (nullable id<SCStackLayouterProtocol>)layouterForPosition:(SCStackViewControllerPosition)position;
 
 
+/** Registers a decoration for the given position
+ *
+ * The Stack draws the decoration's edge shadow and dimming overlay on every
+ * view controller stacked on the position and updates their opacities based on
+ * the view controllers' visible percentages.
+ *
+ * @param decoration The SCStackDecoration to use, nil removes the current one
+ * @param position The SCStackViewControllerPosition to decorate
+ */
+- (void)registerDecoration:(nullable SCStackDecoration *)decoration
+			   forPosition:(SCStackViewControllerPosition)position;
+
+/** Retrieve the decoration for the given position
+ *
+ * @param position The SCStackViewControllerPosition to fetch the decoration for
+ */
+- (nullable SCStackDecoration *)decorationForPosition:(SCStackViewControllerPosition)position;
+
+
 /**-----------------------------------------------------------------------------
  * @name Performing an Operation
  * -----------------------------------------------------------------------------
@@ -257,6 +346,85 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
 			  animated:(BOOL)animated
 			completion:(nullable void(^)(void))completion;
 
+/**-----------------------------------------------------------------------------
+ * @name Enqueuing Operations
+ * -----------------------------------------------------------------------------
+ */
+
+/** The methods above must be called on the main thread and are ignored while
+ * an animation is running if shouldBlockInteractionWhileAnimating is set.
+ *
+ * The enqueue variants below can be called from any thread. Operations are
+ * applied on the main thread, in the order they were enqueued, at the next run
+ * loop turn or, if an animation is running, once it finishes. Everything
+ * pending at that point is applied in a single layout pass and operations that
+ * cancel each other out (e.g. pushing and then popping the same view
+ * controller) are skipped. Completion blocks are always called, in order, on
+ * the main thread.
+ */
+
+/** Enqueues a push, see pushViewController:atPosition:unfold:animated:completion: */
+- (void)enqueuePushViewController:(nonnull UIViewController *)viewController
+					   atPosition:(SCStackViewControllerPosition)position
+						   unfold:(BOOL)unfold
+						 animated:(BOOL)animated
+					   completion:(nullable void(^)(void))completion;
+
+/** Enqueues a pop, see popViewControllerAtPosition:animated:completion:
+ *
+ * The view controller to pop is resolved when the operation is applied
+ */
+- (void)enqueuePopViewControllerAtPosition:(SCStackViewControllerPosition)position
+								  animated:(BOOL)animated
+								completion:(nullable void(^)(void))completion;
+
+/** Enqueues a pop, see popViewController:animated:completion: */
+- (void)enqueuePopViewController:(nonnull UIViewController *)viewController
+						animated:(BOOL)animated
+					  completion:(nullable void(^)(void))completion;
+
+/** Enqueues a navigation, see navigateToStep:inViewController:animated:completion: */
+- (void)enqueueNavigateToStep:(nonnull SCStackNavigationStep *)step
+			 inViewController:(nonnull UIViewController *)viewController
+					 animated:(BOOL)animated
+				   completion:(nullable void(^)(void))completion;
+
+/** Enqueues a navigation steps registration, see registerNavigationSteps:forViewController: */
+- (void)enqueueRegisterNavigationSteps:(nullable NSArray *)navigationSteps forViewController:(nonnull UIViewController *)viewController;
+
+
+/**-----------------------------------------------------------------------------
+ * @name Observing Visibility
+ * -----------------------------------------------------------------------------
+ */
+
+/** Registers a visibility observer for the given view controller
+ *
+ * The thresholds are checked against the visible percentages the Stack
+ * calculates during its layout pass and the handler is only called when one
+ * of them is crossed, once per crossed threshold, in crossing order. A
+ * threshold is reached when the visible percentage is greater than or equal
+ * to it and the view controller is visible (so 0.0f is reached as soon as any
+ * part of it is).
+ *
+ * Prefer this over pulling visiblePercentageForViewController: from
+ * stackViewController:didNavigateToOffset:, which gets called on every
+ * scroll view tick.
+ *
+ * Registering a new observer replaces the previous one and popped view
+ * controllers lose their observers.
+ *
+ * @param viewController The view controller to observe
+ * @param thresholds An array of visible percentages (NSNumber, 0.0f to 1.0f)
+ * or nil to use the percentages of the view controller's navigation steps
+ * @param handler Block called on the main thread with the crossed threshold
+ * and the current visible percentage or nil to remove the observer
+ */
+- (void)registerVisibilityObserverForViewController:(nonnull UIViewController *)viewController
+										 thresholds:(nullable NSArray *)thresholds
+											handler:(nullable void(^)(UIViewController * __nonnull viewController, CGFloat threshold, CGFloat visiblePercentage))handler;
+
+
 /**-----------------------------------------------------------------------------
  * @name Querying the Stack state
  * -----------------------------------------------------------------------------
@@ -301,6 +469,66 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
  */
 - (CGFloat)visiblePercentageForViewController:(nonnull UIViewController *)viewController;
 
+
+/**
+ * @return The size the Stack uses for the given view controller when
+ * calculating insets, final frames and pagination
+ * @param viewController The view controller for which to fetch the size
+ *
+ * The size is resolved from the delegate's
+ * stackViewController:sizeForViewController:position: method, then from the
+ * view controller's preferredContentSize and only then from its view's bounds.
+ * Zero dimensions in a size hint are replaced with the Stack's own.
+ *
+ * View controllers that provide a size hint and whose views are not yet
+ * loaded will only have their views loaded when they approach the Stack's
+ * visible bounds.
+ */
+- (CGSize)sizeForViewController:(nonnull UIViewController *)viewController;
+
+
+/** Recalculates the final frames on the next layout pass
+ *
+ * Call this when the sizes returned by the delegate's
+ * stackViewController:sizeForViewController:position: method change. Changes
+ * to the view controllers' preferredContentSize are picked up automatically
+ * on iOS 8 and above.
+ */
+- (void)invalidateSizeHints;
+
+
+/**
+ * @return The frame the given view controller has when fully unfolded or
+ * CGRectNull if it isn't stacked
+ * @param viewController The view controller for which to fetch the final frame
+ *
+ * Available as soon as the view controller is pushed, before its view gets
+ * loaded or inserted, which makes it a good size to prepare content for.
+ */
+- (CGRect)finalFrameForViewController:(nonnull UIViewController *)viewController;
+
+
+/**
+ * @return The summed up sizes of all the view controllers stacked on the
+ * given position
+ * @param position The position for which to sum up the sizes
+ */
+- (CGSize)summedSizeForViewControllersAtPosition:(SCStackViewControllerPosition)position;
+
+
+/**
+ * @return The summed up sizes of the view controllers stacked on the given
+ * position within the given range
+ * @param position The position for which to sum up the sizes
+ * @param range The range of view controllers to sum up, in stacking order
+ *
+ * Sizes resolve the same way as in sizeForViewController: and get cached along
+ * with the final frames, making this a constant time lookup meant for
+ * layouters. The cache is rebuilt whenever the final frames are and dropped by
+ * invalidateSizeHints.
+ */
+- (CGSize)summedSizeForViewControllersAtPosition:(SCStackViewControllerPosition)position inRange:(NSRange)range;
+
 @end
 
 
@@ -351,16 +579,37 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
 		didNavigateToOffset:(CGPoint)offset;
 
 
-/** Delegate method that the Stack calls when its scrollView rests on a predefined step
+/** Delegate method that the Stack calls when its scrollView comes to rest
+ *
+ * The offset is resolved to the view controller it unfolds, which isn't
+ * necessarily the last visible one. Offsets within half a point of one of its
+ * navigation steps report that step, any other offset reports a new step with
+ * the view controller's resolved visible percentage.
+ *
  * @param stackViewController The calling StackViewController
- * @param step The step it stopped on
- * @param controller The view controller that own the step
+ * @param step The step it stopped on or a step with the resolved percentage
+ * @param controller The view controller the offset resolves to
  *
  */
 - (void)stackViewController:(nonnull SCStackViewController *)stackViewController
 		  didNavigateToStep:(nonnull SCStackNavigationStep *)step
 		   inViewController:(nonnull UIViewController *)controller;
 
+
+/** Delegate method that the Stack calls when it needs the size of a stacked
+ * view controller
+ * @param stackViewController The calling StackViewController
+ * @param controller The view controller for which the size is needed
+ * @param position The position where the view controller resides
+ *
+ * @return The size to be used for the view controller or CGSizeZero to fall
+ * back to its preferredContentSize or view bounds
+ *
+ */
+- (CGSize)stackViewController:(nonnull SCStackViewController *)stackViewController
+		sizeForViewController:(nonnull UIViewController *)controller
+					 position:(SCStackViewControllerPosition)position;
+
 @end
 
 
@@ -381,13 +630,15 @@ typedef NS_OPTIONS(NSUInteger, SCStackViewControllerNavigationContraintType) {
 
 
 /**
- * @return ViewController's view width
+ * @return ViewController's view width or, when stacked, the width the parent
+ * Stack resolves for it without loading its view
  */
 - (CGFloat)sc_viewWidth;
 
 
 /**
- * @return ViewController's view height
+ * @return ViewController's view height or, when stacked, the height the parent
+ * Stack resolves for it without loading its view
  */
 - (CGFloat)sc_viewHeight;
 
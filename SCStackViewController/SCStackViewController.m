@@ -13,6 +13,89 @@
 #import "SCEasingFunction.h"
 #import "SCStackNavigationStep.h"
 #import "SCStackLayouterProtocol.h"
+#import "SCStackOcclusion.h"
+#import "SCStackSpatialIndex.h"
+#import "SCStackLayoutScheduler.h"
+#import "SCStackDecoration.h"
+
+/** Where an offset falls within a view controller's navigation steps */
+typedef struct {
+	__unsafe_unretained UIViewController *viewController;
+	CGFloat percentage;		/** How much of the view controller the offset unfolds */
+	NSUInteger stepIndex;	/** Last navigation step at or before the offset, NSNotFound if none */
+	CGFloat progress;		/** Progress from that step towards the next one */
+	BOOL isOnStep;			/** Whether the offset rests on the step, within tolerance */
+} SCStackStepResolution;
+
+typedef NS_ENUM(NSUInteger, SCStackAxis) {
+	SCStackAxisNone,
+	SCStackAxisVertical,
+	SCStackAxisHorizontal
+};
+
+typedef NS_ENUM(NSUInteger, SCStackOperationType) {
+	SCStackOperationTypePush,
+	SCStackOperationTypePop,
+	SCStackOperationTypePopAtPosition,
+	SCStackOperationTypeNavigate,
+	SCStackOperationTypeRegisterNavigationSteps
+};
+
+@interface SCStackOperation : NSObject
+
+@property (nonatomic, assign) SCStackOperationType type;
+
+@property (nonatomic, strong) UIViewController *viewController;
+@property (nonatomic, assign) SCStackViewControllerPosition position;
+
+@property (nonatomic, strong) SCStackNavigationStep *step;
+@property (nonatomic, strong) NSArray *navigationSteps;
+
+@property (nonatomic, assign) BOOL unfold;
+@property (nonatomic, assign) BOOL animated;
+
+@property (nonatomic, copy) void(^completion)(void);
+
+@property (nonatomic, assign) BOOL cancelled;
+
+@end
+
+@implementation SCStackOperation
+
+@end
+
+@interface SCStackVisibilityObserver : NSObject
+
+@property (nonatomic, strong) NSArray *thresholds;
+@property (nonatomic, assign) BOOL usesNavigationSteps;
+@property (nonatomic, strong) NSArray *observedNavigationSteps;
+
+@property (nonatomic, copy) void(^handler)(UIViewController *viewController, CGFloat threshold, CGFloat visiblePercentage);
+
+@property (nonatomic, assign) NSUInteger reachedThresholdsCount;
+@property (nonatomic, assign) CGFloat visiblePercentage;
+
+@end
+
+@implementation SCStackVisibilityObserver
+
+@end
+
+@interface SCStackDecorationState : NSObject
+
+@property (nonatomic, strong) SCStackDecoration *decoration;
+
+@property (nonatomic, assign) CGSize size;
+@property (nonatomic, assign) CGFloat shadowOpacity;
+@property (nonatomic, assign) CGFloat dimmingOpacity;
+
+@property (nonatomic, strong) CALayer *dimmingLayer;
+
+@end
+
+@implementation SCStackDecorationState
+
+@end
 
 @interface SCStackViewController () <SCStackViewControllerViewDelegate, UIScrollViewDelegate>
 
@@ -25,12 +108,54 @@
 
 @property (nonatomic, strong) NSMutableDictionary *layouters;
 @property (nonatomic, strong) NSMutableDictionary *finalFrames;
+@property (nonatomic, strong) NSMutableDictionary *stackIndexes;
+@property (nonatomic, strong) NSMutableDictionary *stackPositions;
+@property (nonatomic, strong) NSMutableDictionary *summedSizes;
+@property (nonatomic, strong) SCStackSpatialIndex *finalFramesIndex;
+@property (nonatomic, strong) NSMutableDictionary *layoutCandidateIndexes;
 
 @property (nonatomic, strong) NSMutableDictionary *navigationSteps;
 @property (nonatomic, strong) NSMutableDictionary *previousNavigationSteps;
-@property (nonatomic, strong) NSMutableDictionary *stepsForOffsets;
 
 @property (nonatomic, strong) NSMutableDictionary *visiblePercentages;
+@property (nonatomic, assign) CGFloat rootVerticalVisiblePercentage;
+@property (nonatomic, assign) CGFloat rootHorizontalVisiblePercentage;
+
+@property (nonatomic, strong) NSMutableDictionary *visibilityObservers;
+@property (nonatomic, strong) NSMapTable *observedViewControllers;
+@property (nonatomic, strong) NSMutableSet *changedVisibilityKeys;
+@property (nonatomic, strong) NSMutableArray *pendingVisibilityCallbacks;
+
+@property (nonatomic, strong) NSMutableDictionary *decorations;
+@property (nonatomic, strong) NSMutableDictionary *decorationStates;
+
+@property (nonatomic, strong) NSMutableDictionary *appliedFrames;
+@property (nonatomic, strong) NSMutableDictionary *appliedSublayerTransforms;
+
+@property (nonatomic, assign) NSUInteger appliedFrameUpdatesCount;
+@property (nonatomic, assign) NSUInteger skippedFrameUpdatesCount;
+@property (nonatomic, assign) NSUInteger appliedSublayerTransformUpdatesCount;
+@property (nonatomic, assign) NSUInteger skippedSublayerTransformUpdatesCount;
+@property (nonatomic, assign) NSUInteger finalFrameUpdatesCount;
+
+@property (nonatomic, assign) BOOL isAnimatingLayoutChange;
+
+@property (nonatomic, assign) BOOL needsFullLayoutPass;
+@property (nonatomic, assign) CGPoint lastLayoutContentOffset;
+@property (nonatomic, assign) CGSize lastLayoutSize;
+@property (nonatomic, assign) BOOL needsFinalFramesUpdate;
+
+@property (nonatomic, assign) SCStackAxis draggingAxis;
+
+@property (nonatomic, strong) NSMutableDictionary *sampledFrames;
+@property (nonatomic, strong) NSMutableDictionary *sampledSublayerTransforms;
+@property (nonatomic, assign) NSUInteger sampleIndex;
+@property (nonatomic, strong) NSMutableOrderedSet *sampledInsertions;
+@property (nonatomic, assign) BOOL isRunningKeyframeAnimation;
+
+@property (nonatomic, strong) NSMutableArray *pendingOperations;
+@property (nonatomic, assign) BOOL isOperationsDrainScheduled;
+@property (nonatomic, assign) BOOL isApplyingOperations;
 
 @property (nonatomic, assign) BOOL isViewVisible;
 @property (nonatomic, assign) BOOL isRootViewControllerVisible;
@@ -41,6 +166,14 @@
 
 @end
 
+static const CGFloat keyframeAnimationSamplesPerSecond = 60.0f;
+
+static const CGFloat navigationStepOffsetTolerance = 0.5f;
+
+static NSString *const kKeyframeAnimationPositionKey = @"SCStackKeyframeAnimationPosition";
+static NSString *const kKeyframeAnimationBoundsKey = @"SCStackKeyframeAnimationBounds";
+static NSString *const kKeyframeAnimationSublayerTransformKey = @"SCStackKeyframeAnimationSublayerTransform";
+
 @implementation SCStackViewController
 
 - (void)dealloc
@@ -75,10 +208,25 @@
 	
 	self.layouters = [NSMutableDictionary dictionary];
 	self.finalFrames = [NSMutableDictionary dictionary];
+	self.stackIndexes = [NSMutableDictionary dictionary];
+	self.stackPositions = [NSMutableDictionary dictionary];
+	self.summedSizes = [NSMutableDictionary dictionary];
+	self.layoutCandidateIndexes = [NSMutableDictionary dictionary];
 	self.navigationSteps = [NSMutableDictionary dictionary];
 	self.previousNavigationSteps = [NSMutableDictionary dictionary];
-	self.stepsForOffsets = [NSMutableDictionary dictionary];
 	self.visiblePercentages = [NSMutableDictionary dictionary];
+	self.rootVerticalVisiblePercentage = 1.0f;
+	self.rootHorizontalVisiblePercentage = 1.0f;
+	self.needsFullLayoutPass = YES;
+	self.visibilityObservers = [NSMutableDictionary dictionary];
+	self.observedViewControllers = [NSMapTable strongToWeakObjectsMapTable];
+	self.changedVisibilityKeys = [NSMutableSet set];
+	self.pendingVisibilityCallbacks = [NSMutableArray array];
+	self.decorations = [NSMutableDictionary dictionary];
+	self.decorationStates = [NSMutableDictionary dictionary];
+	self.appliedFrames = [NSMutableDictionary dictionary];
+	self.appliedSublayerTransforms = [NSMutableDictionary dictionary];
+	self.pendingOperations = [NSMutableArray array];
 	
 	self.easingFunction = [SCEasingFunction easingFunctionWithType:SCEasingFunctionTypeSineEaseInOut];
 	self.animationDuration = 0.25f;
@@ -105,15 +253,21 @@
 				animated:(BOOL)animated
 {
 	[self.layouters setObject:layouter forKey:@(position)];
+	self.needsFullLayoutPass = YES;
+	self.needsFinalFramesUpdate = YES;
 	
 	if (!self.isViewLoaded) {
 		return;
 	}
 	
+	[self.view setNeedsLayout];
+	
 	if(animated) {
+		self.isAnimatingLayoutChange = YES;
 		[UIView animateWithDuration:self.animationDuration animations:^{
 			[self updateFramesAndTriggerAppearanceCallbacks];
 		}];
+		self.isAnimatingLayoutChange = NO;
 	} else {
 		[self updateFramesAndTriggerAppearanceCallbacks];
 	}
@@ -130,6 +284,28 @@
 	return self.layouters[@(position)];
 }
 
+- (void)registerDecoration:(SCStackDecoration *)decoration forPosition:(SCStackViewControllerPosition)position
+{
+	if(decoration) {
+		[self.decorations setObject:decoration forKey:@(position)];
+	} else {
+		[self.decorations removeObjectForKey:@(position)];
+	}
+	
+	self.needsFullLayoutPass = YES;
+	
+	if (!self.isViewLoaded) {
+		return;
+	}
+	
+	[self updateFramesAndTriggerAppearanceCallbacks];
+}
+
+- (SCStackDecoration *)decorationForPosition:(SCStackViewControllerPosition)position
+{
+	return self.decorations[@(position)];
+}
+
 - (void)registerNavigationSteps:(NSArray *)navigationSteps forViewController:(UIViewController *)viewController
 {
 	if(navigationSteps == nil) {
@@ -151,13 +327,13 @@
 				  animated:(BOOL)animated
 				completion:(void(^)(void))completion
 {
-	if(self.scrollView.isRunningAnimation && self.shouldBlockInteractionWhileAnimating) {
+	if(self.isRunningAnimation && self.shouldBlockInteractionWhileAnimating) {
 		return;
 	}
 	
 	NSAssert(viewController != nil, @"Trying to push a nil view controller");
 	
-	if([[self.loadedControllers.allValues valueForKeyPath:@"@unionOfArrays.self"] containsObject:viewController]) {
+	if(self.stackIndexes[@([viewController hash])] != nil) {
 		NSLog(@"Trying to push an already pushed view controller");
 		
 		if(unfold) {
@@ -171,25 +347,18 @@
 	NSMutableArray *viewControllers = self.loadedControllers[@(position)];
 	[viewControllers addObject:viewController];
 	
-	[self updateFinalFramesForPosition:position];
-	
-	id<SCStackLayouterProtocol> layouter = self.layouters[@(position)];
-	
-	viewController.view.frame = [self.finalFrames[@(viewController.hash)] CGRectValue];
+	// Adopt the child first so that its size resolves through the stack (sc_viewWidth/sc_viewHeight)
+	[viewController willMoveToParentViewController:self];
+	[self addChildViewController:viewController];
 	
-	BOOL shouldStackAboveRoot = NO;
-	if([layouter respondsToSelector:@selector(shouldStackControllersAboveRoot)]) {
-		shouldStackAboveRoot = [layouter shouldStackControllersAboveRoot];
-	}
+	[self updateFinalFramesForPosition:position];
 	
-	[viewController willMoveToParentViewController:self];
-	if(shouldStackAboveRoot) {
-		[self.scrollView insertSubview:viewController.view aboveSubview:self.rootViewController.view];
-	} else {
-		[self.scrollView insertSubview:viewController.view atIndex:0];
+	// View controllers providing a size hint get their views loaded when they approach visibility
+	if(viewController.isViewLoaded || ![self hasSizeHintForViewController:viewController]) {
+		viewController.view.frame = [self.finalFrames[@(viewController.hash)] CGRectValue];
+		[self insertViewForViewController:viewController atPosition:position];
 	}
 	
-	[self addChildViewController:viewController];
 	[viewController didMoveToParentViewController:self];
 	
 	[self updateBoundsIgnoringNavigationContraints];
@@ -205,7 +374,7 @@
 		};
 		
 		if(animated) {
-			[self.scrollView setContentOffset:[self maximumInsetForPosition:position] easingFunction:self.easingFunction duration:self.animationDuration completion:cleanup];
+			[self animateToContentOffset:[self maximumInsetForPosition:position] completion:cleanup];
 		} else {
 			[self.scrollView setContentOffset:[self maximumInsetForPosition:position]];
 			cleanup();
@@ -224,7 +393,7 @@
 						   animated:(BOOL)animated
 						 completion:(void(^)(void))completion
 {
-	if(self.scrollView.isRunningAnimation && self.shouldBlockInteractionWhileAnimating) {
+	if(self.isRunningAnimation && self.shouldBlockInteractionWhileAnimating) {
 		return;
 	}
 	
@@ -247,7 +416,7 @@
 				 animated:(BOOL)animated
 			   completion:(void(^)(void))completion
 {
-	if(self.scrollView.isRunningAnimation && self.shouldBlockInteractionWhileAnimating) {
+	if(self.isRunningAnimation && self.shouldBlockInteractionWhileAnimating) {
 		return;
 	}
 	
@@ -257,17 +426,28 @@
 	
 	SCStackViewControllerPosition position = [self positionForViewController:viewController];
 	
+	NSUInteger index = [self.stackIndexes[@([viewController hash])] unsignedIntegerValue];
+	
 	UIViewController *previousViewController;
-	if([self.loadedControllers[@(position)] indexOfObject:viewController] == 0) {
+	if(index == 0) {
 		previousViewController = self.rootViewController;
 	} else {
-		previousViewController = [self.loadedControllers[@(position)] objectAtIndex:[self.loadedControllers[@(position)] indexOfObject:viewController] - 1];
+		previousViewController = [self.loadedControllers[@(position)] objectAtIndex:index - 1];
 	}
 	
 	void(^cleanup)(void) = ^{
 		[self.loadedControllers[@(position)] removeObject:viewController];
 		[self.finalFrames removeObjectForKey:@([viewController hash])];
+		[self.finalFramesIndex removeObject:viewController];
+		[self.layoutCandidateIndexes removeAllObjects];
+		[self.stackIndexes removeObjectForKey:@([viewController hash])];
+		[self.stackPositions removeObjectForKey:@([viewController hash])];
 		[self.visiblePercentages removeObjectForKey:@([viewController hash])];
+		[self.visibilityObservers removeObjectForKey:@([viewController hash])];
+		[self.observedViewControllers removeObjectForKey:@([viewController hash])];
+		[self removeDecorationFromViewController:viewController];
+		[self.appliedFrames removeObjectForKey:@([viewController hash])];
+		[self.appliedSublayerTransforms removeObjectForKey:@([viewController hash])];
 		[self updateFinalFramesForPosition:position];
 		[self updateBoundsIgnoringNavigationContraints];
 		
@@ -276,7 +456,9 @@
 		}
 		
 		[viewController willMoveToParentViewController:nil];
-		[viewController.view removeFromSuperview];
+		if(viewController.isViewLoaded) {
+			[viewController.view removeFromSuperview];
+		}
 		[viewController removeFromParentViewController];
 		
 		if([self.visibleControllers containsObject:viewController]) {
@@ -331,7 +513,7 @@
 			  animated:(BOOL)animated
 			completion:(void(^)(void))completion
 {
-	if(self.scrollView.isRunningAnimation && self.shouldBlockInteractionWhileAnimating) {
+	if(self.isRunningAnimation && self.shouldBlockInteractionWhileAnimating) {
 		return;
 	}
 	
@@ -431,7 +613,7 @@
             [weakSelf registerNavigationSteps:self.previousNavigationSteps[@([viewController hash])] forViewController:viewController];
         }
 		
-		if(![weakSelf.scrollView isRunningAnimation]) {
+		if(![weakSelf isRunningAnimation]) {
 			[weakSelf.previousNavigationSteps removeObjectForKey:@([viewController hash])];
 		}
 		
@@ -443,13 +625,106 @@
 	};
 	
 	if(animated) {
-		[self.scrollView setContentOffset:offset easingFunction:self.easingFunction duration:self.animationDuration completion:cleanup];
+		[self animateToContentOffset:offset completion:cleanup];
 	} else {
 		[self.scrollView setContentOffset:offset];
 		cleanup();
 	}
 }
 
+- (void)enqueuePushViewController:(UIViewController *)viewController
+					   atPosition:(SCStackViewControllerPosition)position
+						   unfold:(BOOL)unfold
+						 animated:(BOOL)animated
+					   completion:(void(^)(void))completion
+{
+	NSAssert(viewController != nil, @"Trying to push a nil view controller");
+	
+	SCStackOperation *operation = [[SCStackOperation alloc] init];
+	operation.type = SCStackOperationTypePush;
+	operation.viewController = viewController;
+	operation.position = position;
+	operation.unfold = unfold;
+	operation.animated = animated;
+	operation.completion = completion;
+	
+	[self enqueueOperation:operation];
+}
+
+- (void)enqueuePopViewControllerAtPosition:(SCStackViewControllerPosition)position
+								  animated:(BOOL)animated
+								completion:(void(^)(void))completion
+{
+	SCStackOperation *operation = [[SCStackOperation alloc] init];
+	operation.type = SCStackOperationTypePopAtPosition;
+	operation.position = position;
+	operation.animated = animated;
+	operation.completion = completion;
+	
+	[self enqueueOperation:operation];
+}
+
+- (void)enqueuePopViewController:(UIViewController *)viewController
+						animated:(BOOL)animated
+					  completion:(void(^)(void))completion
+{
+	SCStackOperation *operation = [[SCStackOperation alloc] init];
+	operation.type = SCStackOperationTypePop;
+	operation.viewController = viewController;
+	operation.animated = animated;
+	operation.completion = completion;
+	
+	[self enqueueOperation:operation];
+}
+
+- (void)enqueueNavigateToStep:(SCStackNavigationStep *)step
+			 inViewController:(UIViewController *)viewController
+					 animated:(BOOL)animated
+				   completion:(void(^)(void))completion
+{
+	SCStackOperation *operation = [[SCStackOperation alloc] init];
+	operation.type = SCStackOperationTypeNavigate;
+	operation.step = step;
+	operation.viewController = viewController;
+	operation.animated = animated;
+	operation.completion = completion;
+	
+	[self enqueueOperation:operation];
+}
+
+- (void)enqueueRegisterNavigationSteps:(NSArray *)navigationSteps forViewController:(UIViewController *)viewController
+{
+	SCStackOperation *operation = [[SCStackOperation alloc] init];
+	operation.type = SCStackOperationTypeRegisterNavigationSteps;
+	operation.navigationSteps = navigationSteps;
+	operation.viewController = viewController;
+	
+	[self enqueueOperation:operation];
+}
+
+- (void)registerVisibilityObserverForViewController:(UIViewController *)viewController
+										 thresholds:(NSArray *)thresholds
+											handler:(void(^)(UIViewController *viewController, CGFloat threshold, CGFloat visiblePercentage))handler
+{
+	if(handler == nil) {
+		[self.visibilityObservers removeObjectForKey:@([viewController hash])];
+		[self.observedViewControllers removeObjectForKey:@([viewController hash])];
+		return;
+	}
+	
+	SCStackVisibilityObserver *observer = [[SCStackVisibilityObserver alloc] init];
+	observer.handler = handler;
+	observer.usesNavigationSteps = (thresholds == nil);
+	observer.thresholds = [thresholds sortedArrayUsingSelector:@selector(compare:)];
+	
+	// Only crossings that happen after the registration are reported
+	observer.visiblePercentage = [self visiblePercentageForViewController:viewController];
+	observer.reachedThresholdsCount = [self reachedThresholdsCountForPercentage:observer.visiblePercentage inThresholds:observer.thresholds];
+	
+	[self.visibilityObservers setObject:observer forKey:@([viewController hash])];
+	[self.observedViewControllers setObject:viewController forKey:@([viewController hash])];
+}
+
 - (NSArray *)viewControllersForPosition:(SCStackViewControllerPosition)position
 {
 	return [self.loadedControllers[@(position)] copy];
@@ -457,10 +732,22 @@
 
 - (NSArray *)visibleViewControllers
 {
-	NSArray *viewControllers = [self viewControllersForPosition:[self positionForViewController:self.visibleControllers.lastObject]];
+	SCStackViewControllerPosition position = [self positionForViewController:self.visibleControllers.lastObject];
+	
+	// View controllers from other positions go last, same as when they were looked up in the position's array
+	NSUInteger(^stackIndex)(UIViewController *) = ^NSUInteger(UIViewController *viewController) {
+		NSNumber *index = self.stackIndexes[@([viewController hash])];
+		if(index == nil || [self.stackPositions[@([viewController hash])] integerValue] != position) {
+			return NSNotFound;
+		}
+		
+		return [index unsignedIntegerValue];
+	};
 	
 	NSArray *sortedViewControllers = [self.visibleControllers sortedArrayUsingComparator:^NSComparisonResult(id obj1, id obj2) {
-		return [@([viewControllers indexOfObject:obj1]) compare:@([viewControllers indexOfObject:obj2])];
+		NSUInteger firstIndex = stackIndex(obj1);
+		NSUInteger secondIndex = stackIndex(obj2);
+		return (firstIndex < secondIndex ? NSOrderedAscending : (firstIndex > secondIndex ? NSOrderedDescending : NSOrderedSame));
 	}];
 	
 	if(self.isRootViewControllerVisible) {
@@ -476,7 +763,7 @@
 		return self.isRootViewControllerVisible;
 	}
 	
-	return [self.visibleViewControllers containsObject:viewController];
+	return [self.visibleControllers containsObject:viewController];
 }
 
 - (CGFloat)visiblePercentageForViewController:(UIViewController *)viewController
@@ -488,11 +775,76 @@
 	return [self.visiblePercentages[@([viewController hash])] floatValue];
 }
 
+- (CGSize)sizeForViewController:(UIViewController *)viewController
+{
+	CGSize size;
+	if([self sizeHint:&size forViewController:viewController]) {
+		return size;
+	}
+	
+	return viewController.view.bounds.size;
+}
+
+- (void)invalidateSizeHints
+{
+	self.needsFinalFramesUpdate = YES;
+	
+	// Layouters can query the sums before the next layout pass, rebuild them from the new sizes on demand
+	[self.summedSizes removeAllObjects];
+	
+	if(self.isViewLoaded) {
+		[self.view setNeedsLayout];
+	}
+}
+
+- (CGRect)finalFrameForViewController:(UIViewController *)viewController
+{
+	NSValue *finalFrame = self.finalFrames[@([viewController hash])];
+	if(finalFrame == nil) {
+		return CGRectNull;
+	}
+	
+	return [finalFrame CGRectValue];
+}
+
+- (CGSize)summedSizeForViewControllersAtPosition:(SCStackViewControllerPosition)position
+{
+	return [self summedSizeForViewControllersAtPosition:position inRange:NSMakeRange(0, [self.loadedControllers[@(position)] count])];
+}
+
+- (CGSize)summedSizeForViewControllersAtPosition:(SCStackViewControllerPosition)position inRange:(NSRange)range
+{
+	NSUInteger count = [self.loadedControllers[@(position)] count];
+	NSAssert(NSMaxRange(range) <= count, @"Range out of bounds");
+	
+	// Rebuilt along with the final frames, or on demand after being invalidated
+	NSData *summedSizes = self.summedSizes[@(position)];
+	if(summedSizes.length != sizeof(CGSize) * (count + 1)) {
+		[self updateSummedSizesForPosition:position];
+		summedSizes = self.summedSizes[@(position)];
+	}
+	
+	const CGSize *sizes = summedSizes.bytes;
+	CGSize start = sizes[range.location];
+	CGSize end = sizes[NSMaxRange(range)];
+	
+	return CGSizeMake(end.width - start.width, end.height - start.height);
+}
+
 - (BOOL)visible
 {
 	return self.isViewVisible;
 }
 
+- (void)resetLayoutStatistics
+{
+	self.appliedFrameUpdatesCount = 0;
+	self.skippedFrameUpdatesCount = 0;
+	self.appliedSublayerTransformUpdatesCount = 0;
+	self.skippedSublayerTransformUpdatesCount = 0;
+	self.finalFrameUpdatesCount = 0;
+}
+
 #pragma mark - UIViewController View Events
 
 - (void)loadView
@@ -527,6 +879,44 @@
 {
 	[super viewWillLayoutSubviews];
 	
+	// Nothing depends on the Stack's origin, moving it around is free
+	if(!self.needsFinalFramesUpdate && CGSizeEqualToSize(self.view.bounds.size, self.lastLayoutSize)) {
+		return;
+	}
+	
+	// Nested Stacks get laid out after their parents, at most once per frame
+	if(self.sc_stackViewController && !CGSizeEqualToSize(self.lastLayoutSize, CGSizeZero)) {
+		[[SCStackLayoutScheduler sharedScheduler] scheduleLayoutForStackViewController:self];
+		return;
+	}
+	
+	[self updateLayoutForCurrentSize];
+}
+
+- (void)performScheduledLayout
+{
+	if(!self.isViewLoaded || (!self.needsFinalFramesUpdate && CGSizeEqualToSize(self.view.bounds.size, self.lastLayoutSize))) {
+		return;
+	}
+	
+	[self updateLayoutForCurrentSize];
+}
+
+- (void)updateLayoutForCurrentSize
+{
+	self.lastLayoutSize = self.view.bounds.size;
+	self.needsFinalFramesUpdate = NO;
+	
+	// Zero dimensions in the size hints resolve to the Stack's own
+	[self.summedSizes removeAllObjects];
+	
+	// The stack's bounds might have changed along with the children's autoresizing
+	[self.appliedFrames removeAllObjects];
+	[self.appliedSublayerTransforms removeAllObjects];
+	
+	// The index's cells follow the Stack's size
+	self.finalFramesIndex = nil;
+	
     for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
 		[self updateFinalFramesForPosition:position];
 	}
@@ -543,6 +933,13 @@
 	[self updateBoundsUsingNavigationContraints];
 }
 
+- (void)preferredContentSizeDidChangeForChildContentContainer:(id<UIContentContainer>)container
+{
+	[super preferredContentSizeDidChangeForChildContentContainer:container];
+	
+	[self invalidateSizeHints];
+}
+
 - (void)viewDidAppear:(BOOL)animated
 {
 	[super viewDidAppear:animated];
@@ -565,11 +962,50 @@
 
 - (void)updateFinalFramesForPosition:(SCStackViewControllerPosition)position
 {
+	if(self.finalFramesIndex == nil) {
+		CGSize cellSize = (CGRectIsEmpty(self.view.bounds) ? [[UIScreen mainScreen] bounds].size : self.view.bounds.size);
+		self.finalFramesIndex = [[SCStackSpatialIndex alloc] initWithCellSize:cellSize];
+		
+		for(SCStackViewControllerPosition otherPosition = SCStackViewControllerPositionTop; otherPosition <= SCStackViewControllerPositionRight; otherPosition++) {
+			for(UIViewController *controller in self.loadedControllers[@(otherPosition)]) {
+				NSValue *finalFrame = self.finalFrames[@([controller hash])];
+				if(finalFrame && otherPosition != position) {
+					[self.finalFramesIndex setFrame:[finalFrame CGRectValue] forObject:controller];
+				}
+			}
+		}
+	}
+	
+	// Layouters sum up the sizes of the view controllers before each one, do it once for all of them
+	[self updateSummedSizesForPosition:position];
+	
 	NSMutableArray *viewControllers = self.loadedControllers[@(position)];
 	[viewControllers enumerateObjectsUsingBlock:^(UIViewController *controller, NSUInteger idx, BOOL *stop) {
 		CGRect finalFrame = [self.layouters[@(position)] finalFrameForViewController:controller withIndex:idx atPosition:position withinGroup:viewControllers inStackController:self];
 		[self.finalFrames setObject:[NSValue valueWithCGRect:finalFrame] forKey:@([controller hash])];
+		[self.stackIndexes setObject:@(idx) forKey:@([controller hash])];
+		[self.stackPositions setObject:@(position) forKey:@([controller hash])];
+		[self.finalFramesIndex setFrame:finalFrame forObject:controller];
+		self.finalFrameUpdatesCount++;
+	}];
+	
+	self.needsFullLayoutPass = YES;
+}
+
+// Prefix sums of the view controllers' sizes, the first entry is always zero
+- (void)updateSummedSizesForPosition:(SCStackViewControllerPosition)position
+{
+	NSArray *viewControllers = self.loadedControllers[@(position)];
+	
+	NSMutableData *summedSizes = [NSMutableData dataWithLength:sizeof(CGSize) * (viewControllers.count + 1)];
+	CGSize *sizes = summedSizes.mutableBytes;
+	
+	[viewControllers enumerateObjectsUsingBlock:^(UIViewController *controller, NSUInteger idx, BOOL *stop) {
+		CGSize size = [self sizeForViewController:controller];
+		sizes[idx + 1] = CGSizeMake(sizes[idx].width + size.width, sizes[idx].height + size.height);
 	}];
+	
+	[self.summedSizes setObject:summedSizes forKey:@(position)];
 }
 
 #pragma mark Navigation Contraints
@@ -581,13 +1017,12 @@
 	
 	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
 		
-		NSArray *viewControllerHashes = [self.loadedControllers[@(position)] valueForKeyPath:@"@distinctUnionOfObjects.hash"];
-		NSArray *finalFrameKeys = [self.finalFrames.allKeys filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSNumber *hash, NSDictionary *bindings) {
-			return [viewControllerHashes containsObject:hash];
-		}]];
-		
-		NSArray *frames = [self.finalFrames objectsForKeys:finalFrameKeys notFoundMarker:[NSNull null]];
-		for(NSValue *value in frames) {
+		for(UIViewController *viewController in self.loadedControllers[@(position)]) {
+			NSValue *value = self.finalFrames[@([viewController hash])];
+			if(value == nil) {
+				continue;
+			}
+			
 			switch (position) {
 				case SCStackViewControllerPositionTop:
 					insets.top = MAX(insets.top, ABS(CGRectGetMinY([value CGRectValue])));
@@ -607,6 +1042,8 @@
 		}
 	}
 	
+	insets = [self insetsByLockingAxis:insets];
+	
 	[self.scrollView setDelegate:nil];
 	
 	CGPoint offset = self.scrollView.contentOffset;
@@ -657,6 +1094,8 @@
 		}
 	}
 	
+	insets = [self insetsByLockingAxis:insets];
+	
 	[self.scrollView setContentInset:UIEdgeInsetsIntegral(insets)];
 }
 
@@ -678,7 +1117,7 @@
 	
 	SCStackViewControllerPosition lastVisibleControllerPosition = [self positionForViewController:lastVisibleController];
 	NSArray *viewControllersArray = self.loadedControllers[@(lastVisibleControllerPosition)];
-	NSUInteger visibleControllerIndex = [viewControllersArray indexOfObject:lastVisibleController];
+	NSUInteger visibleControllerIndex = [self.stackIndexes[@([lastVisibleController hash])] unsignedIntegerValue];
 	
 	BOOL isReversed = NO;
 	if([self.layouters[@(lastVisibleControllerPosition)] respondsToSelector:@selector(isReversed)]) {
@@ -753,9 +1192,69 @@
 		}
 	}
 	
+	insets = [self insetsByLockingAxis:insets];
+	
 	[self.scrollView setContentInset:UIEdgeInsetsIntegral(insets)];
 }
 
+#pragma mark Axis locking
+
+// The axis the Stack currently moves on, only one of them can be away from the root at a time
+- (SCStackAxis)lockedAxis
+{
+	CGPoint offset = self.scrollView.contentOffset;
+	
+	if(offset.y != 0.0f && offset.x != 0.0f) {
+		return (self.draggingAxis != SCStackAxisNone ? self.draggingAxis : SCStackAxisVertical);
+	} else if(offset.y != 0.0f) {
+		return SCStackAxisVertical;
+	} else if(offset.x != 0.0f) {
+		return SCStackAxisHorizontal;
+	}
+	
+	return self.draggingAxis;
+}
+
+- (UIEdgeInsets)insetsByLockingAxis:(UIEdgeInsets)insets
+{
+	switch ([self lockedAxis]) {
+		case SCStackAxisVertical:
+			insets.left = insets.right = 0.0f;
+			break;
+		case SCStackAxisHorizontal:
+			insets.top = insets.bottom = 0.0f;
+			break;
+		case SCStackAxisNone:
+			break;
+	}
+	
+	return insets;
+}
+
+// Decides which axis a gesture starting on the root moves on
+- (SCStackAxis)axisForVelocity:(CGPoint)velocity
+{
+	BOOL hasVerticalControllers = ([self.loadedControllers[@(SCStackViewControllerPositionTop)] count] || [self.loadedControllers[@(SCStackViewControllerPositionBottom)] count]);
+	BOOL hasHorizontalControllers = ([self.loadedControllers[@(SCStackViewControllerPositionLeft)] count] || [self.loadedControllers[@(SCStackViewControllerPositionRight)] count]);
+	
+	if(!hasHorizontalControllers) {
+		return (hasVerticalControllers ? SCStackAxisVertical : SCStackAxisNone);
+	} else if(!hasVerticalControllers) {
+		return SCStackAxisHorizontal;
+	}
+	
+	switch (self.axisLockingPolicy) {
+		case SCStackViewControllerAxisLockingPolicyDominantVelocity:
+			return (ABS(velocity.x) > ABS(velocity.y) ? SCStackAxisHorizontal : SCStackAxisVertical);
+		case SCStackViewControllerAxisLockingPolicyPreferVertical:
+			return (velocity.y != 0.0f || velocity.x == 0.0f ? SCStackAxisVertical : SCStackAxisHorizontal);
+		case SCStackViewControllerAxisLockingPolicyPreferHorizontal:
+			return (velocity.x != 0.0f || velocity.y == 0.0f ? SCStackAxisHorizontal : SCStackAxisVertical);
+	}
+	
+	return SCStackAxisVertical;
+}
+
 #pragma mark Appearance callbacks and framesetting
 
 - (BOOL)shouldAutomaticallyForwardAppearanceMethods
@@ -765,18 +1264,68 @@
 
 - (void)updateFramesAndTriggerAppearanceCallbacks
 {
-	CGPoint offset = self.scrollView.contentOffset;
+	[self updateFramesAndTriggerAppearanceCallbacksSkippingIdleAxes:NO];
+}
+
+// Scrolling only moves one axis at a time, the view controllers on the other one can be left alone
+- (void)updateFramesAndTriggerAppearanceCallbacksSkippingIdleAxes:(BOOL)skipIdleAxes
+{
+	// Enqueued operations get a single layout pass once all of them were applied
+	if(self.isApplyingOperations) {
+		return;
+	}
+	
+	// Batch all the writes in a single transaction and skip implicit animations unless explicitly animating
+	[CATransaction begin];
+	[CATransaction setDisableActions:!self.isAnimatingLayoutChange];
+	
+	[self _updateFramesAndTriggerAppearanceCallbacksWithContentOffset:self.scrollView.contentOffset skippingIdleAxes:skipIdleAxes];
+	
+	[CATransaction commit];
+	
+	// Visibility observers get called once all the frames are set
+	NSArray *visibilityCallbacks = [self.pendingVisibilityCallbacks copy];
+	[self.pendingVisibilityCallbacks removeAllObjects];
+	
+	for(void(^callback)(void) in visibilityCallbacks) {
+		callback();
+	}
+	
+	// Stacks nested in the children might have been resized by this pass
+	[[SCStackLayoutScheduler sharedScheduler] performScheduledLayoutsNestedInStackViewController:self];
+}
+
+// When sampling (keyframe animations) the new values are recorded instead of applied and only the visibility state is tracked
+- (void)_updateFramesAndTriggerAppearanceCallbacksWithContentOffset:(CGPoint)offset skippingIdleAxes:(BOOL)skipIdleAxes
+{
+	BOOL isSampling = (self.sampledFrames != nil);
+	CGRect bounds = (CGRect){offset, self.scrollView.bounds.size};
+	
+	// Layouters only get the offset along their own axis so that vertical and horizontal ones can be mixed
+	CGPoint verticalOffset = CGPointMake(0.0f, offset.y);
+	CGPoint horizontalOffset = CGPointMake(offset.x, 0.0f);
+	
+	BOOL canSkipIdleAxes = (skipIdleAxes && !isSampling && !self.needsFullLayoutPass);
+	BOOL isVerticalAxisDirty = (!canSkipIdleAxes || offset.y != self.lastLayoutContentOffset.y);
+	BOOL isHorizontalAxisDirty = (!canSkipIdleAxes || offset.x != self.lastLayoutContentOffset.x);
 	
 	// Fetch the active layouter based on the current offset and use it to set the root's frame
+	BOOL prefersHorizontalAxis = (offset.x != 0.0f && [self lockedAxis] == SCStackAxisHorizontal);
+	
 	id<SCStackLayouterProtocol> activeLayouter;
-	if(offset.y < 0.0f) {
+	CGPoint activeOffset = offset;
+	if(offset.y < 0.0f && !prefersHorizontalAxis) {
 		activeLayouter = self.layouters[@(SCStackViewControllerPositionTop)];
+		activeOffset = verticalOffset;
 	} else if(offset.x < 0.0f) {
 		activeLayouter = self.layouters[@(SCStackViewControllerPositionLeft)];
-	} else if(offset.y > 0.0f){
+		activeOffset = horizontalOffset;
+	} else if(offset.y > 0.0f && !prefersHorizontalAxis){
 		activeLayouter = self.layouters[@(SCStackViewControllerPositionBottom)];
+		activeOffset = verticalOffset;
 	} else if(offset.x > 0.0f) {
 		activeLayouter = self.layouters[@(SCStackViewControllerPositionRight)];
+		activeOffset = horizontalOffset;
 	} else {
 		activeLayouter = self.lastUsedLayouter;
 	}
@@ -785,119 +1334,81 @@
 	
 	CGRect newRootViewControllerFrame;
 	if([activeLayouter respondsToSelector:@selector(currentFrameForRootViewController:contentOffset:inStackController:)]) {
-		newRootViewControllerFrame = [activeLayouter currentFrameForRootViewController:self.rootViewController contentOffset:offset inStackController:self];
+		newRootViewControllerFrame = [activeLayouter currentFrameForRootViewController:self.rootViewController contentOffset:activeOffset inStackController:self];
 	} else {
 		newRootViewControllerFrame = self.view.bounds;
 	}
 	
-	__block CGRect rootRemainder = CGRectIntersection(self.scrollView.bounds, newRootViewControllerFrame);
-	
+	// Fetch all the new frames first, the visibility of every view controller depends on all of them
+	NSMutableDictionary *candidateIndexes = [NSMutableDictionary dictionary];
+	NSMutableDictionary *nextFrames = [NSMutableDictionary dictionary];
 	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
 		
-		id<SCStackLayouterProtocol> layouter = self.layouters[@(position)];
-		
-		BOOL shouldStackControllersAboveRoot = NO;
-		if([layouter respondsToSelector:@selector(shouldStackControllersAboveRoot)]) {
-			shouldStackControllersAboveRoot = [layouter shouldStackControllersAboveRoot];
+		BOOL isVertical = (position == SCStackViewControllerPositionTop || position == SCStackViewControllerPositionBottom);
+		if(!(isVertical ? isVerticalAxisDirty : isHorizontalAxisDirty)) {
+			continue;
 		}
 		
-		CGRectEdge edge = [self edgeFromOffset:offset];
-		__block CGRect remainder;
+		id<SCStackLayouterProtocol> layouter = self.layouters[@(position)];
+		CGPoint axisOffset = (isVertical ? verticalOffset : horizontalOffset);
 		
-		// Determine the amount of unobstructed space the stacked view controllers might be seen through
-		if(shouldStackControllersAboveRoot) {
-			remainder = [self subtractRect:CGRectIntersection(self.scrollView.bounds, self.view.bounds) fromRect:self.scrollView.bounds withEdge:edge];
-		} else {
-			remainder = [self subtractRect:CGRectIntersection(self.scrollView.bounds, newRootViewControllerFrame) fromRect:self.scrollView.bounds withEdge:edge];
-		}
+		NSIndexSet *indexes = [self layoutCandidateIndexesForPosition:position bounds:(CGRect){axisOffset, bounds.size}];
+		[candidateIndexes setObject:indexes forKey:@(position)];
 		
-		BOOL isReversed = NO;
-		if([layouter respondsToSelector:@selector(isReversed)]) {
-			isReversed = [layouter isReversed];
-		}
+		// Views get inserted a viewport ahead along the scrolling axis so they're ready by the time they show up
+		CGRect insertionBounds = (isVertical ? CGRectInset(bounds, 0.0f, -CGRectGetHeight(bounds)) : CGRectInset(bounds, -CGRectGetWidth(bounds), 0.0f));
 		
-		NSArray *viewControllersArray = self.loadedControllers[@(position)];
-		[viewControllersArray enumerateObjectsUsingBlock:^(UIViewController *viewController, NSUInteger index, BOOL *stop) {
-			
-			CGRect nextFrame =  [layouter currentFrameForViewController:viewController withIndex:index atPosition:position finalFrame:[self.finalFrames[@(viewController.hash)] CGRectValue] contentOffset:offset inStackController:self];
+		[self.loadedControllers[@(position)] enumerateObjectsAtIndexes:indexes options:0 usingBlock:^(UIViewController *viewController, NSUInteger index, BOOL *stop) {
 			
-			// If using a reversed layouter adjust the frame to normal
-			CGRect adjustedFrame = nextFrame;
+			CGRect nextFrame =  [layouter currentFrameForViewController:viewController withIndex:index atPosition:position finalFrame:[self.finalFrames[@(viewController.hash)] CGRectValue] contentOffset:axisOffset inStackController:self];
 			
-			if(index > 0) {
-				if(isReversed) {
-					switch (position) {
-						case SCStackViewControllerPositionTop: {
-							NSArray *remainingViewControllers = [viewControllersArray subarrayWithRange:NSMakeRange(index + 1, viewControllersArray.count - index - 1)];
-							CGFloat totalSize = [[remainingViewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
-							adjustedFrame.origin.y = [self maximumInsetForPosition:position].y + totalSize;
-							break;
-						}
-						case SCStackViewControllerPositionLeft: {
-							NSArray *remainingViewControllers = [viewControllersArray subarrayWithRange:NSMakeRange(index + 1, viewControllersArray.count - index - 1)];
-							CGFloat totalSize = [[remainingViewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
-							adjustedFrame.origin.x = [self maximumInsetForPosition:position].x + totalSize;
-							break;
-						}
-						case SCStackViewControllerPositionBottom: {
-							NSArray *remainingViewControllers = [viewControllersArray subarrayWithRange:NSMakeRange(index, viewControllersArray.count - index)];
-							CGFloat totalSize = [[remainingViewControllers valueForKeyPath:@"@sum.sc_viewHeight"] floatValue];
-							adjustedFrame.origin.y = CGRectGetHeight(self.view.bounds) + [self maximumInsetForPosition:position].y - totalSize;
-							break;
-						}
-						case SCStackViewControllerPositionRight: {
-							NSArray *remainingViewControllers = [viewControllersArray subarrayWithRange:NSMakeRange(index, viewControllersArray.count - index)];
-							CGFloat totalSize = [[remainingViewControllers valueForKeyPath:@"@sum.sc_viewWidth"] floatValue];
-							adjustedFrame.origin.x = CGRectGetWidth(self.view.bounds) + [self maximumInsetForPosition:position].x - totalSize;
-							break;
-						}
-					}
+			// Deferred views get loaded and inserted once they get close to the visible bounds, sampling passes leave that for after the sampling
+			if(![self isViewInsertedForViewController:viewController] && CGRectIntersectsRect(insertionBounds, nextFrame)) {
+				if(isSampling) {
+					[self.sampledInsertions addObject:viewController];
 				} else {
-					NSArray *previousViewControllers = [viewControllersArray subarrayWithRange:NSMakeRange(0, index)];
-					for(UIViewController *controller in previousViewControllers) {
-						adjustedFrame = [self subtractRect:controller.view.frame fromRect:adjustedFrame withEdge:edge];
-					}
+					[self insertViewForViewController:viewController atPosition:position];
 				}
 			}
 			
-			CGRect intersection = CGRectIntersection(remainder, adjustedFrame);
+			[nextFrames setObject:[NSValue valueWithCGRect:nextFrame] forKey:@([viewController hash])];
+		}];
+	}
+	
+	[self updateVisiblePercentagesWithFrames:nextFrames candidateIndexes:candidateIndexes rootViewControllerFrame:newRootViewControllerFrame bounds:bounds];
+	
+	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
+		
+		BOOL isVertical = (position == SCStackViewControllerPositionTop || position == SCStackViewControllerPositionBottom);
+		if(!(isVertical ? isVerticalAxisDirty : isHorizontalAxisDirty)) {
+			continue;
+		}
+		
+		id<SCStackLayouterProtocol> layouter = self.layouters[@(position)];
+		CGPoint axisOffset = (isVertical ? verticalOffset : horizontalOffset);
+		
+		[self.loadedControllers[@(position)] enumerateObjectsAtIndexes:candidateIndexes[@(position)] options:0 usingBlock:^(UIViewController *viewController, NSUInteger index, BOOL *stop) {
 			
-			// If a view controller's frame does intersect the remainder then it's visible
-			BOOL visible = ((position == SCStackViewControllerPositionLeft || position == SCStackViewControllerPositionRight) && CGRectGetWidth(intersection) > 0.0f);
-			visible = visible || ((position == SCStackViewControllerPositionTop || position == SCStackViewControllerPositionBottom) && CGRectGetHeight(intersection) > 0.0f);
+			CGRect nextFrame = [nextFrames[@([viewController hash])] CGRectValue];
+			BOOL isViewInserted = ([self isViewInsertedForViewController:viewController] || [self.sampledInsertions containsObject:viewController]);
 			
-			visible = visible && self.isViewVisible;
+			BOOL visible = ([self.visiblePercentages[@([viewController hash])] floatValue] > 0.0f) && self.isViewVisible;
 			
-			if(visible) {
-				
-				switch (position) {
-					case SCStackViewControllerPositionTop:
-					case SCStackViewControllerPositionBottom:
-					{
-						[self.visiblePercentages setObject:@(roundf((CGRectGetHeight(intersection) * 1000) / CGRectGetHeight(adjustedFrame))/1000.0f) forKey:@([viewController hash])];
-						break;
-					}
-					case SCStackViewControllerPositionLeft:
-					case SCStackViewControllerPositionRight:
-					{
-						[self.visiblePercentages setObject:@(roundf((CGRectGetWidth(intersection) * 1000) / CGRectGetWidth(adjustedFrame))/1000.0f) forKey:@([viewController hash])];
-						break;
-					}
-				}
-				
-				// And if it's visible then we prepare for the next view controller by reducing the remainder some more
-				remainder = [self subtractRect:CGRectIntersection(remainder, adjustedFrame) fromRect:remainder withEdge:edge];
-				
-				if(shouldStackControllersAboveRoot) {
-					rootRemainder = [self subtractRect:CGRectIntersection(rootRemainder, adjustedFrame) fromRect:rootRemainder withEdge:edge];
+			// Sampling passes only keep track of the visibility, the appearance callbacks are triggered by the following real pass
+			if(isSampling) {
+				if(visible && ![self.visibleControllers containsObject:viewController]) {
+					[self.visibleControllers addObject:viewController];
+				} else if(!visible && [self.visibleControllers containsObject:viewController]) {
+					[self.visibleControllers removeObject:viewController];
 				}
 			}
 			
 			// Finally, trigger appearance callbacks and new frame
-			if(visible && ![self.visibleControllers containsObject:viewController]) {
+			if(!isSampling && visible && ![self.visibleControllers containsObject:viewController]) {
 				[self.visibleControllers addObject:viewController];
+				[self.changedVisibilityKeys addObject:@([viewController hash])];
 				[viewController beginAppearanceTransition:YES animated:NO];
-				[viewController.view setFrame:nextFrame];
+				[self applyFrame:nextFrame toViewController:viewController];
 				[viewController endAppearanceTransition];
 				
 				dispatch_async(dispatch_get_main_queue(), ^{
@@ -906,10 +1417,11 @@
 					}
 				});
 				
-			} else if(!visible && [self.visibleControllers containsObject:viewController]) {
+			} else if(!isSampling && !visible && [self.visibleControllers containsObject:viewController]) {
 				[self.visibleControllers removeObject:viewController];
+				[self.changedVisibilityKeys addObject:@([viewController hash])];
 				[viewController beginAppearanceTransition:NO animated:NO];
-				[viewController.view setFrame:nextFrame];
+				[self applyFrame:nextFrame toViewController:viewController];
 				[viewController endAppearanceTransition];
 				
 				dispatch_async(dispatch_get_main_queue(), ^{
@@ -918,72 +1430,869 @@
 					}
 				});
 				
-			} else {
-				[viewController.view setFrame:nextFrame];
+			} else if(isViewInserted) {
+				[self applyFrame:nextFrame toViewController:viewController];
 			}
 			
-			if([layouter respondsToSelector:@selector(sublayerTransformForViewController:withIndex:atPosition:finalFrame:contentOffset:inStackController:)]) {
+			if(isViewInserted && [layouter respondsToSelector:@selector(sublayerTransformForViewController:withIndex:atPosition:finalFrame:contentOffset:inStackController:)]) {
 				CATransform3D transform = [layouter sublayerTransformForViewController:viewController
 																			 withIndex:index
 																			atPosition:position
 																			finalFrame:[self.finalFrames[@(viewController.hash)] CGRectValue]
-																		 contentOffset:offset
+																		 contentOffset:axisOffset
 																	 inStackController:self];
-				[viewController.view.layer setSublayerTransform:transform];
+				[self applySublayerTransform:transform toViewController:viewController];
+			}
+			
+			if(!isSampling && isViewInserted) {
+				[self applyDecorationToViewController:viewController atPosition:position];
 			}
 		}];
 	}
 	
 	// Figure out if the root is still visible or not and call its appearance methods
-	BOOL hasVerticalControllers = ([self.loadedControllers[@(SCStackViewControllerPositionTop)] count] || [self.loadedControllers[@(SCStackViewControllerPositionBottom)] count]);
-	BOOL hasHorizontalController = ([self.loadedControllers[@(SCStackViewControllerPositionLeft)] count] || [self.loadedControllers[@(SCStackViewControllerPositionRight)] count]);
+	BOOL visible = ([self.visiblePercentages[@([self.rootViewController hash])] floatValue] > 0.0f) && self.isViewVisible;
+	
+	if(!isSampling && visible && !self.isRootViewControllerVisible) {
+		self.isRootViewControllerVisible = YES;
+		[self.changedVisibilityKeys addObject:@([self.rootViewController hash])];
+		[self.rootViewController beginAppearanceTransition:YES animated:NO];
+		[self applyFrame:newRootViewControllerFrame toViewController:self.rootViewController];
+		[self.rootViewController endAppearanceTransition];
+		
+		dispatch_async(dispatch_get_main_queue(), ^{
+			if([self.delegate respondsToSelector:@selector(stackViewController:didShowViewController:position:)]) {
+				[self.delegate stackViewController:self didShowViewController:self.rootViewController position:-1];
+			}
+		});
+		
+	} else if(!isSampling && !visible && self.isRootViewControllerVisible) {
+		self.isRootViewControllerVisible = NO;
+		[self.changedVisibilityKeys addObject:@([self.rootViewController hash])];
+		[self.rootViewController beginAppearanceTransition:NO animated:NO];
+		[self applyFrame:newRootViewControllerFrame toViewController:self.rootViewController];
+		[self.rootViewController endAppearanceTransition];
+		
+		dispatch_async(dispatch_get_main_queue(), ^{
+			if([self.delegate respondsToSelector:@selector(stackViewController:didHideViewController:position:)]) {
+				[self.delegate stackViewController:self didHideViewController:self.rootViewController position:-1];
+			}
+		});
+		
+	} else {
+		self.isRootViewControllerVisible = visible;
+		[self applyFrame:newRootViewControllerFrame toViewController:self.rootViewController];
+	}
+	
+	if([activeLayouter respondsToSelector:@selector(sublayerTransformForRootViewController:contentOffset:inStackController:)]) {
+		CATransform3D transform = [activeLayouter sublayerTransformForRootViewController:self.rootViewController
+																		   contentOffset:activeOffset
+																	   inStackController:self];
+		[self applySublayerTransform:transform toViewController:self.rootViewController];
+	}
+	
+	if(!isSampling) {
+		self.lastLayoutContentOffset = offset;
+		self.needsFullLayoutPass = NO;
+		
+		[self updateVisibilityObservers];
+	}
+}
+
+#pragma mark Visibility
+
+// Layouters keep the view controllers within one of their own lengths of their final frames so the ones whose final frames
+// are more than a viewport away from the bounds can't be seen. They keep their last frame and visibility state.
+- (NSIndexSet *)layoutCandidateIndexesForPosition:(SCStackViewControllerPosition)position bounds:(CGRect)bounds
+{
+	NSArray *viewControllers = self.loadedControllers[@(position)];
+	
+	NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+	
+	void(^addViewController)(UIViewController *) = ^(UIViewController *viewController) {
+		NSNumber *stackPosition = self.stackPositions[@([viewController hash])];
+		NSNumber *stackIndex = self.stackIndexes[@([viewController hash])];
+		if(stackPosition && [stackPosition integerValue] == position && [stackIndex unsignedIntegerValue] < viewControllers.count) {
+			[indexes addIndex:[stackIndex unsignedIntegerValue]];
+		}
+	};
+	
+	CGRect searchRect = CGRectInset(bounds, -CGRectGetWidth(bounds), -CGRectGetHeight(bounds));
+	[self.finalFramesIndex enumerateObjectsIntersectingRect:searchRect usingBlock:^(UIViewController *viewController, CGRect frame, BOOL *stop) {
+		addViewController(viewController);
+	}];
+	
+	for(UIViewController *viewController in self.visibleControllers) {
+		addViewController(viewController);
+	}
+	
+	// Reversed layouters move the view controllers away from their final frames
+	BOOL isReversed = NO;
+	if([self.layouters[@(position)] respondsToSelector:@selector(isReversed)]) {
+		isReversed = [self.layouters[@(position)] isReversed];
+	}
+	
+	// Sampling passes can't touch the state and they need values for every view controller
+	if(isReversed || self.needsFullLayoutPass || self.sampledFrames) {
+		if(!self.sampledFrames) {
+			[self.layoutCandidateIndexes setObject:[indexes copy] forKey:@(position)];
+		}
+		
+		return [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, viewControllers.count)];
+	}
+	
+	// The ones laid out by the previous pass get another one so that they're hidden properly on their way out
+	NSIndexSet *previousIndexes = self.layoutCandidateIndexes[@(position)];
+	[self.layoutCandidateIndexes setObject:[indexes copy] forKey:@(position)];
+	
+	[previousIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+		if(index < viewControllers.count) {
+			[indexes addIndex:index];
+		}
+	}];
+	
+	return indexes;
+}
+
+// Resolves the exposed extent of every view along its scrolling axis using the actual frames and z-order (the scroll view's subview order)
+- (void)updateVisiblePercentagesWithFrames:(NSDictionary *)frames
+						  candidateIndexes:(NSDictionary *)candidateIndexes
+				   rootViewControllerFrame:(CGRect)rootViewControllerFrame
+									bounds:(CGRect)bounds
+{
+	NSMutableDictionary *zIndexes = [NSMutableDictionary dictionaryWithCapacity:self.scrollView.subviews.count];
+	[self.scrollView.subviews enumerateObjectsUsingBlock:^(UIView *view, NSUInteger index, BOOL *stop) {
+		[zIndexes setObject:@(index) forKey:@([view hash])];
+	}];
+	
+	for(NSUInteger axis = 0; axis < 2; axis++) {
+		
+		BOOL isVertical = (axis == 0);
+		
+		SCStackViewControllerPosition firstPosition = (isVertical ? SCStackViewControllerPositionTop : SCStackViewControllerPositionLeft);
+		SCStackViewControllerPosition secondPosition = (isVertical ? SCStackViewControllerPositionBottom : SCStackViewControllerPositionRight);
+		
+		// Only dirty axes have candidates
+		if(candidateIndexes[@(firstPosition)] == nil) {
+			continue;
+		}
+		
+		NSMutableArray *viewControllers = [NSMutableArray arrayWithObject:self.rootViewController];
+		[viewControllers addObjectsFromArray:[self.loadedControllers[@(firstPosition)] objectsAtIndexes:candidateIndexes[@(firstPosition)]]];
+		[viewControllers addObjectsFromArray:[self.loadedControllers[@(secondPosition)] objectsAtIndexes:candidateIndexes[@(secondPosition)]]];
+		
+		NSMutableData *intervalsData = [NSMutableData dataWithLength:sizeof(SCStackOcclusionInterval) * viewControllers.count];
+		SCStackOcclusionInterval *intervals = intervalsData.mutableBytes;
+		
+		NSUInteger count = 0;
+		for(UIViewController *viewController in viewControllers) {
+			
+			// Views that aren't in the scroll view can't be seen
+			if(![viewController isEqual:self.rootViewController] && ![self isViewInsertedForViewController:viewController]) {
+				[self setVisiblePercentage:0.0f forViewController:viewController];
+				continue;
+			}
+			
+			CGRect frame = ([viewController isEqual:self.rootViewController] ? rootViewControllerFrame : [frames[@([viewController hash])] CGRectValue]);
+			
+			intervals[count].start = (isVertical ? CGRectGetMinY(frame) : CGRectGetMinX(frame));
+			intervals[count].end = (isVertical ? CGRectGetMaxY(frame) : CGRectGetMaxX(frame));
+			intervals[count].zIndex = [zIndexes[@([viewController.view hash])] integerValue];
+			count++;
+		}
+		
+		SCStackOcclusionResolveIntervals(intervals, count,
+										 (isVertical ? CGRectGetMinY(bounds) : CGRectGetMinX(bounds)),
+										 (isVertical ? CGRectGetMaxY(bounds) : CGRectGetMaxX(bounds)));
+		
+		count = 0;
+		for(UIViewController *viewController in viewControllers) {
+			
+			if(![viewController isEqual:self.rootViewController] && ![self isViewInsertedForViewController:viewController]) {
+				continue;
+			}
+			
+			SCStackOcclusionInterval interval = intervals[count++];
+			
+			CGFloat length = interval.end - interval.start;
+			CGFloat percentage = (length > 0.0f ? roundf((interval.exposedLength * 1000) / length) / 1000.0f : 0.0f);
+			
+			if(![viewController isEqual:self.rootViewController]) {
+				[self setVisiblePercentage:percentage forViewController:viewController];
+			} else if(isVertical) {
+				self.rootVerticalVisiblePercentage = percentage;
+			} else {
+				self.rootHorizontalVisiblePercentage = percentage;
+			}
+		}
+	}
+	
+	// The root can be covered from both axes
+	CGFloat rootPercentage = MIN(self.rootVerticalVisiblePercentage, self.rootHorizontalVisiblePercentage);
+	[self setVisiblePercentage:rootPercentage forViewController:self.rootViewController];
+}
+
+// Visibility observers only get checked for the view controllers whose percentages changed
+- (void)setVisiblePercentage:(CGFloat)percentage forViewController:(UIViewController *)viewController
+{
+	NSNumber *previousPercentage = self.visiblePercentages[@([viewController hash])];
+	if(previousPercentage && [previousPercentage floatValue] == percentage) {
+		return;
+	}
+	
+	[self.visiblePercentages setObject:@(percentage) forKey:@([viewController hash])];
+	
+	// Sampling passes get rolled back, the real pass after them compares against the restored values
+	if(self.sampledFrames == nil) {
+		[self.changedVisibilityKeys addObject:@([viewController hash])];
+	}
+}
+
+// Only touch the views when the values actually change, every write can invalidate the children's layout
+- (void)applyFrame:(CGRect)frame toViewController:(UIViewController *)viewController
+{
+	if(self.sampledFrames) {
+		[self recordSample:[NSValue valueWithCGRect:frame] inDictionary:self.sampledFrames forViewController:viewController];
+		return;
+	}
 	
-	BOOL visible = (hasHorizontalController && CGRectGetWidth(rootRemainder) > 0.0f);
-	visible = visible || (hasVerticalControllers && CGRectGetHeight(rootRemainder) > 0.0f);
-	visible = visible || (!hasHorizontalController && !hasVerticalControllers);
+	NSValue *appliedFrame = self.appliedFrames[@([viewController hash])];
+	if(appliedFrame && CGRectEqualToRect([appliedFrame CGRectValue], frame)) {
+		self.skippedFrameUpdatesCount++;
+		return;
+	}
 	
-	visible = visible && self.isViewVisible;
+	[viewController.view setFrame:frame];
+	[self.appliedFrames setObject:[NSValue valueWithCGRect:frame] forKey:@([viewController hash])];
+	self.appliedFrameUpdatesCount++;
+}
+
+- (void)applySublayerTransform:(CATransform3D)transform toViewController:(UIViewController *)viewController
+{
+	if(self.sampledSublayerTransforms) {
+		[self recordSample:[NSValue valueWithCATransform3D:transform] inDictionary:self.sampledSublayerTransforms forViewController:viewController];
+		return;
+	}
+	
+	NSValue *appliedTransform = self.appliedSublayerTransforms[@([viewController hash])];
+	if(appliedTransform && CATransform3DEqualToTransform([appliedTransform CATransform3DValue], transform)) {
+		self.skippedSublayerTransformUpdatesCount++;
+		return;
+	}
+	
+	[viewController.view.layer setSublayerTransform:transform];
+	[self.appliedSublayerTransforms setObject:[NSValue valueWithCATransform3D:transform] forKey:@([viewController hash])];
+	self.appliedSublayerTransformUpdatesCount++;
+}
+
+#pragma mark Decorations
+
+// Static layer properties are set once per decoration and shadow paths once per size, passes only touch opacities
+- (void)applyDecorationToViewController:(UIViewController *)viewController atPosition:(SCStackViewControllerPosition)position
+{
+	SCStackDecoration *decoration = self.decorations[@(position)];
+	SCStackDecorationState *state = self.decorationStates[@([viewController hash])];
+	
+	if(state.decoration != decoration) {
+		[self removeDecorationFromViewController:viewController];
+		state = nil;
+	}
+	
+	if(decoration == nil) {
+		return;
+	}
+	
+	CALayer *layer = viewController.view.layer;
+	
+	if(state == nil) {
+		state = [[SCStackDecorationState alloc] init];
+		state.decoration = decoration;
+		state.size = CGSizeMake(-1.0f, -1.0f);
+		state.shadowOpacity = -1.0f;
+		state.dimmingOpacity = -1.0f;
+		
+		if(decoration.shadowOpacity > 0.0f) {
+			[layer setMasksToBounds:NO];
+			[layer setShadowRadius:decoration.shadowRadius];
+			[layer setShadowOffset:CGSizeZero];
+			[layer setShadowColor:decoration.shadowColor.CGColor];
+		}
+		
+		if(decoration.maximumDimmingOpacity > 0.0f) {
+			state.dimmingLayer = [CALayer layer];
+			[state.dimmingLayer setBackgroundColor:decoration.dimmingColor.CGColor];
+		}
+		
+		[self.decorationStates setObject:state forKey:@([viewController hash])];
+	}
+	
+	CGSize size = viewController.view.bounds.size;
+	if(!CGSizeEqualToSize(size, state.size)) {
+		state.size = size;
+		
+		if(decoration.shadowOpacity > 0.0f) {
+			[layer setShadowPath:[SCStackDecoration shadowPathForSize:size position:position extent:decoration.shadowExtent]];
+		}
+		
+		[state.dimmingLayer setFrame:(CGRect){CGPointZero, size}];
+	}
+	
+	// Keep the overlay above any subviews the view controller might have added since
+	if(state.dimmingLayer && layer.sublayers.lastObject != state.dimmingLayer) {
+		[layer addSublayer:state.dimmingLayer];
+	}
+	
+	CGFloat visiblePercentage = [self.visiblePercentages[@([viewController hash])] floatValue];
+	
+	CGFloat shadowOpacity = decoration.shadowOpacity * visiblePercentage;
+	if(decoration.shadowOpacity > 0.0f && shadowOpacity != state.shadowOpacity) {
+		state.shadowOpacity = shadowOpacity;
+		[layer setShadowOpacity:shadowOpacity];
+	}
+	
+	CGFloat dimmingOpacity = decoration.maximumDimmingOpacity * (1.0f - visiblePercentage);
+	if(state.dimmingLayer && dimmingOpacity != state.dimmingOpacity) {
+		state.dimmingOpacity = dimmingOpacity;
+		[state.dimmingLayer setOpacity:dimmingOpacity];
+	}
+}
+
+- (void)removeDecorationFromViewController:(UIViewController *)viewController
+{
+	SCStackDecorationState *state = self.decorationStates[@([viewController hash])];
+	if(state == nil) {
+		return;
+	}
+	
+	[state.dimmingLayer removeFromSuperlayer];
+	
+	if(state.decoration.shadowOpacity > 0.0f && viewController.isViewLoaded) {
+		[viewController.view.layer setShadowOpacity:0.0f];
+		[viewController.view.layer setShadowPath:NULL];
+	}
+	
+	[self.decorationStates removeObjectForKey:@([viewController hash])];
+}
+
+#pragma mark Visibility observers
+
+// Only the view controllers whose visible percentage or visibility changed during the pass can cross thresholds
+- (void)updateVisibilityObservers
+{
+	for(NSNumber *key in self.changedVisibilityKeys) {
+		
+		SCStackVisibilityObserver *observer = self.visibilityObservers[key];
+		UIViewController *viewController = [self.observedViewControllers objectForKey:key];
+		if(observer == nil || viewController == nil) {
+			continue;
+		}
+		
+		// Navigation steps get temporarily replaced when navigating to a step, observe the original ones
+		if(observer.usesNavigationSteps) {
+			NSArray *navigationSteps = (self.previousNavigationSteps[key] ?: self.navigationSteps[key]);
+			if(navigationSteps != observer.observedNavigationSteps) {
+				observer.observedNavigationSteps = navigationSteps;
+				
+				// Re-registering the same steps creates a new array, only different percentages replace the thresholds.
+				// Swapping them isn't a crossing, so recount silently against the last observed percentage.
+				NSArray *thresholds = [navigationSteps valueForKey:@"percentage"];
+				if(![thresholds isEqualToArray:observer.thresholds]) {
+					observer.thresholds = thresholds;
+					observer.reachedThresholdsCount = [self reachedThresholdsCountForPercentage:observer.visiblePercentage inThresholds:thresholds];
+				}
+			}
+		}
+		
+		CGFloat percentage = [self visiblePercentageForViewController:viewController];
+		observer.visiblePercentage = percentage;
+		
+		NSArray *thresholds = observer.thresholds;
+		NSUInteger reachedThresholdsCount = [self reachedThresholdsCountForPercentage:percentage inThresholds:thresholds];
+		
+		if(reachedThresholdsCount == observer.reachedThresholdsCount) {
+			continue;
+		}
+		
+		NSUInteger previousReachedThresholdsCount = MIN(observer.reachedThresholdsCount, thresholds.count);
+		observer.reachedThresholdsCount = reachedThresholdsCount;
+		
+		void(^handler)(UIViewController *, CGFloat, CGFloat) = observer.handler;
+		
+		[self.pendingVisibilityCallbacks addObject:^{
+			if(reachedThresholdsCount > previousReachedThresholdsCount) {
+				for(NSUInteger index = previousReachedThresholdsCount; index < reachedThresholdsCount; index++) {
+					handler(viewController, [thresholds[index] floatValue], percentage);
+				}
+			} else {
+				for(NSUInteger index = previousReachedThresholdsCount; index > reachedThresholdsCount; index--) {
+					handler(viewController, [thresholds[index - 1] floatValue], percentage);
+				}
+			}
+		}];
+	}
+	
+	[self.changedVisibilityKeys removeAllObjects];
+}
+
+// Thresholds are sorted so the reached ones are always a prefix, find its length with a binary search
+- (NSUInteger)reachedThresholdsCountForPercentage:(CGFloat)percentage inThresholds:(NSArray *)thresholds
+{
+	if(percentage <= 0.0f) {
+		return 0;
+	}
+	
+	NSUInteger low = 0, high = thresholds.count;
+	while(low < high) {
+		NSUInteger middle = (low + high) / 2;
+		if([thresholds[middle] floatValue] <= percentage) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	
+	return low;
+}
+
+#pragma mark Keyframe animations
+
+- (BOOL)isRunningAnimation
+{
+	return (self.scrollView.isRunningAnimation || self.isRunningKeyframeAnimation);
+}
+
+- (void)animateToContentOffset:(CGPoint)contentOffset completion:(void(^)(void))completion
+{
+	// Animations are the boundaries at which enqueued operations get applied
+	__weak typeof(self) weakSelf = self;
+	void(^animationCompletion)(void) = ^{
+		if(completion) {
+			completion();
+		}
+		
+		[weakSelf scheduleOperationsDrain];
+	};
+	
+	// Switching axes goes through the root, only one axis moves at a time
+	CGPoint currentOffset = self.scrollView.contentOffset;
+	if((currentOffset.x != 0.0f && contentOffset.y != 0.0f) || (currentOffset.y != 0.0f && contentOffset.x != 0.0f)) {
+		CGPoint rootOffset = CGPointMake((contentOffset.x != 0.0f ? currentOffset.x : 0.0f), (contentOffset.y != 0.0f ? currentOffset.y : 0.0f));
+		if(!CGPointEqualToPoint(rootOffset, currentOffset) && !CGPointEqualToPoint(rootOffset, contentOffset)) {
+			[self animateToContentOffset:rootOffset completion:^{
+				[weakSelf animateToContentOffset:contentOffset completion:completion];
+			}];
+			return;
+		}
+	}
+	
+	if(self.keyframeAnimationsEnabled && self.isViewLoaded) {
+		[self runKeyframeAnimationToContentOffset:contentOffset completion:animationCompletion];
+	} else {
+		[self.scrollView setContentOffset:contentOffset easingFunction:self.easingFunction duration:self.animationDuration completion:animationCompletion];
+	}
+}
+
+// Samples the layouters and the easing function up front and hands the resulting keyframes over to Core Animation
+- (void)runKeyframeAnimationToContentOffset:(CGPoint)targetContentOffset completion:(void(^)(void))completion
+{
+	CGPoint startContentOffset = self.scrollView.contentOffset;
+	NSUInteger samplesCount = MAX(2, (NSUInteger)ceil(self.animationDuration * keyframeAnimationSamplesPerSecond));
+	
+	// Sampling passes alter the visibility state, save it so it can be reconciled when the animation completes
+	NSMutableArray *visibleControllers = [self.visibleControllers mutableCopy];
+	NSMutableDictionary *visiblePercentages = [self.visiblePercentages mutableCopy];
+	BOOL isRootViewControllerVisible = self.isRootViewControllerVisible;
+	CGFloat rootVerticalVisiblePercentage = self.rootVerticalVisiblePercentage;
+	CGFloat rootHorizontalVisiblePercentage = self.rootHorizontalVisiblePercentage;
+	id<SCStackLayouterProtocol> lastUsedLayouter = self.lastUsedLayouter;
+	
+	self.sampledFrames = [NSMutableDictionary dictionary];
+	self.sampledSublayerTransforms = [NSMutableDictionary dictionary];
+	self.sampledInsertions = [NSMutableOrderedSet orderedSet];
+	NSMutableArray *scrollViewBounds = [NSMutableArray arrayWithCapacity:samplesCount + 1];
+	
+	for(NSUInteger sample = 0; sample <= samplesCount; sample++) {
+		CGFloat progress = [self.easingFunction solveForInput:(CGFloat)sample / samplesCount];
+		CGPoint contentOffset = CGPointMake(startContentOffset.x + (targetContentOffset.x - startContentOffset.x) * progress,
+											startContentOffset.y + (targetContentOffset.y - startContentOffset.y) * progress);
+		
+		self.sampleIndex = sample;
+		[self _updateFramesAndTriggerAppearanceCallbacksWithContentOffset:contentOffset skippingIdleAxes:NO];
+		[scrollViewBounds addObject:[NSValue valueWithCGRect:(CGRect){contentOffset, self.scrollView.bounds.size}]];
+	}
+	
+	NSDictionary *sampledFrames = self.sampledFrames;
+	NSDictionary *sampledSublayerTransforms = self.sampledSublayerTransforms;
+	NSOrderedSet *sampledInsertions = self.sampledInsertions;
+	
+	self.sampledFrames = nil;
+	self.sampledSublayerTransforms = nil;
+	self.sampledInsertions = nil;
+	
+	self.visibleControllers = visibleControllers;
+	self.visiblePercentages = visiblePercentages;
+	self.isRootViewControllerVisible = isRootViewControllerVisible;
+	self.rootVerticalVisiblePercentage = rootVerticalVisiblePercentage;
+	self.rootHorizontalVisiblePercentage = rootHorizontalVisiblePercentage;
+	self.lastUsedLayouter = lastUsedLayouter;
+	
+	self.isRunningKeyframeAnimation = YES;
+	
+	BOOL wasScrollEnabled = self.scrollView.isScrollEnabled;
+	[self.scrollView setScrollEnabled:NO];
+	
+	NSMutableArray *animatedLayers = [NSMutableArray arrayWithObject:self.scrollView.layer];
+	
+	__weak typeof(self) weakSelf = self;
+	
+	[CATransaction begin];
+	[CATransaction setCompletionBlock:^{
+		
+		typeof(self) strongSelf = weakSelf;
+		if(strongSelf) {
+			strongSelf.isRunningKeyframeAnimation = NO;
+			[strongSelf.scrollView setScrollEnabled:wasScrollEnabled];
+			
+			// The model is already at the final offset, a real pass reconciles visibility, decorations, observers and appearance callbacks
+			[strongSelf.scrollView setContentOffset:targetContentOffset];
+			[strongSelf updateFramesAndTriggerAppearanceCallbacks];
+		}
+		
+		for(CALayer *layer in animatedLayers) {
+			[layer removeAnimationForKey:kKeyframeAnimationPositionKey];
+			[layer removeAnimationForKey:kKeyframeAnimationBoundsKey];
+			[layer removeAnimationForKey:kKeyframeAnimationSublayerTransformKey];
+		}
+		
+		if(completion) {
+			completion();
+		}
+	}];
+	
+	// The model layers jump to the final state straight away and the keyframes only drive the presentation layers.
+	// This covers views inserted for the sampling that never move and keeps hit testing on the destination.
+	[CATransaction setDisableActions:YES];
+	
+	[self.scrollView setDelegate:nil];
+	[self.scrollView setContentOffset:targetContentOffset];
+	[self.scrollView setDelegate:self];
+	
+	// Views that came close to the bounds while sampling get loaded and inserted once, in the order they did
+	for(UIViewController *viewController in sampledInsertions) {
+		if(![self isViewInsertedForViewController:viewController]) {
+			[self insertViewForViewController:viewController atPosition:[self positionForViewController:viewController]];
+		}
+	}
+	
+	for(UIViewController *viewController in self.childViewControllers) {
+		
+		if(![self isViewInsertedForViewController:viewController]) {
+			continue;
+		}
+		
+		NSValue *finalFrame = [sampledFrames[@([viewController hash])] lastObject];
+		if(finalFrame) {
+			[self applyFrame:[finalFrame CGRectValue] toViewController:viewController];
+		}
+		
+		NSValue *finalSublayerTransform = [sampledSublayerTransforms[@([viewController hash])] lastObject];
+		if(finalSublayerTransform) {
+			[self applySublayerTransform:[finalSublayerTransform CATransform3DValue] toViewController:viewController];
+		}
+	}
+	
+	[self.scrollView.layer addAnimation:[self keyframeAnimationWithKeyPath:@"bounds" values:scrollViewBounds] forKey:kKeyframeAnimationBoundsKey];
+	
+	for(UIViewController *viewController in self.childViewControllers) {
+		
+		if(!viewController.isViewLoaded) {
+			continue;
+		}
+		
+		CALayer *layer = viewController.view.layer;
+		
+		NSArray *frames = sampledFrames[@([viewController hash])];
+		if([self samplesRequireAnimation:frames]) {
+			NSMutableArray *positions = [NSMutableArray arrayWithCapacity:frames.count];
+			NSMutableArray *bounds = [NSMutableArray arrayWithCapacity:frames.count];
+			
+			for(NSValue *value in frames) {
+				CGRect frame = [value CGRectValue];
+				[positions addObject:[NSValue valueWithCGPoint:CGPointMake(CGRectGetMinX(frame) + CGRectGetWidth(frame) * layer.anchorPoint.x,
+																		   CGRectGetMinY(frame) + CGRectGetHeight(frame) * layer.anchorPoint.y)]];
+				[bounds addObject:[NSValue valueWithCGRect:(CGRect){layer.bounds.origin, frame.size}]];
+			}
+			
+			[layer addAnimation:[self keyframeAnimationWithKeyPath:@"position" values:positions] forKey:kKeyframeAnimationPositionKey];
+			[layer addAnimation:[self keyframeAnimationWithKeyPath:@"bounds" values:bounds] forKey:kKeyframeAnimationBoundsKey];
+			[animatedLayers addObject:layer];
+		}
+		
+		NSArray *transforms = sampledSublayerTransforms[@([viewController hash])];
+		if([self samplesRequireAnimation:transforms]) {
+			[layer addAnimation:[self keyframeAnimationWithKeyPath:@"sublayerTransform" values:transforms] forKey:kKeyframeAnimationSublayerTransformKey];
+			[animatedLayers addObject:layer];
+		}
+	}
+	
+	[CATransaction commit];
+}
+
+- (CAKeyframeAnimation *)keyframeAnimationWithKeyPath:(NSString *)keyPath values:(NSArray *)values
+{
+	CAKeyframeAnimation *animation = [CAKeyframeAnimation animationWithKeyPath:keyPath];
+	[animation setValues:values];
+	[animation setDuration:self.animationDuration];
+	[animation setCalculationMode:kCAAnimationLinear];
+	[animation setFillMode:kCAFillModeForwards];
+	[animation setRemovedOnCompletion:NO];
+	
+	return animation;
+}
+
+- (BOOL)samplesRequireAnimation:(NSArray *)samples
+{
+	for(NSValue *sample in samples) {
+		if(![sample isEqualToValue:samples.firstObject]) {
+			return YES;
+		}
+	}
+	
+	return NO;
+}
+
+- (void)recordSample:(NSValue *)sample inDictionary:(NSMutableDictionary *)dictionary forViewController:(UIViewController *)viewController
+{
+	NSMutableArray *samples = dictionary[@([viewController hash])];
+	if(samples == nil) {
+		samples = [NSMutableArray array];
+		[dictionary setObject:samples forKey:@([viewController hash])];
+	}
+	
+	// Views that only get close to the bounds halfway through the sampling hold their first values until then
+	while(samples.count < self.sampleIndex) {
+		[samples addObject:sample];
+	}
+	
+	[samples addObject:sample];
+}
+
+#pragma mark Operation queue
+
+- (void)enqueueOperation:(SCStackOperation *)operation
+{
+	@synchronized(self.pendingOperations) {
+		[self.pendingOperations addObject:operation];
+	}
+	
+	[self scheduleOperationsDrain];
+}
+
+// Drains the pending operations on the main thread at the next run loop turn
+- (void)scheduleOperationsDrain
+{
+	@synchronized(self.pendingOperations) {
+		if(self.isOperationsDrainScheduled || self.pendingOperations.count == 0) {
+			return;
+		}
+		
+		self.isOperationsDrainScheduled = YES;
+	}
+	
+	__weak typeof(self) weakSelf = self;
+	dispatch_async(dispatch_get_main_queue(), ^{
+		[weakSelf drainPendingOperations];
+	});
+}
+
+- (void)drainPendingOperations
+{
+	NSAssert([NSThread isMainThread], @"Operations should be drained on the main thread");
+	
+	NSMutableArray *operations;
+	@synchronized(self.pendingOperations) {
+		self.isOperationsDrainScheduled = NO;
+		
+		// Rescheduled by animateToContentOffset:completion: once the running animation finishes
+		if(self.isRunningAnimation || self.pendingOperations.count == 0) {
+			return;
+		}
+		
+		operations = [self.pendingOperations mutableCopy];
+		[self.pendingOperations removeAllObjects];
+	}
+	
+	[self coalesceOperations:operations];
+	
+	// Intermediate states are never displayed, so only do the layout pass once everything was applied
+	self.isApplyingOperations = YES;
+	
+	BOOL needsRefresh = NO;
+	while(operations.count) {
+		SCStackOperation *operation = operations.firstObject;
+		[operations removeObjectAtIndex:0];
+		
+		// Pops and navigations decide based on the visible view controllers, bring those up to date first
+		if(needsRefresh && [self operationReadsVisibility:operation]) {
+			self.isApplyingOperations = NO;
+			[self updateFramesAndTriggerAppearanceCallbacks];
+			self.isApplyingOperations = YES;
+			needsRefresh = NO;
+		}
+		
+		[self applyOperation:operation];
+		needsRefresh = needsRefresh || (!operation.cancelled && operation.type != SCStackOperationTypeRegisterNavigationSteps);
+		
+		// Whatever follows an animated operation has to wait for it to finish
+		if(self.isRunningAnimation) {
+			@synchronized(self.pendingOperations) {
+				[self.pendingOperations replaceObjectsInRange:NSMakeRange(0, 0) withObjectsFromArray:operations];
+			}
+			break;
+		}
+	}
+	
+	self.isApplyingOperations = NO;
+	
+	[self updateFramesAndTriggerAppearanceCallbacks];
+	
+	// The operations updated the bounds against stale visibility, the running animation does it when it finishes
+	if(!self.isRunningAnimation) {
+		[self updateBoundsUsingNavigationContraints];
+	}
+}
+
+- (BOOL)operationReadsVisibility:(SCStackOperation *)operation
+{
+	if(operation.cancelled) {
+		return NO;
+	}
+	
+	switch (operation.type) {
+		case SCStackOperationTypePop:
+		case SCStackOperationTypePopAtPosition:
+		case SCStackOperationTypeNavigate:
+			return YES;
+		default:
+			return NO;
+	}
+}
+
+- (void)coalesceOperations:(NSArray *)operations
+{
+	NSMutableDictionary *pendingPushes = [NSMutableDictionary dictionary];
+	NSMutableDictionary *pendingRegistrations = [NSMutableDictionary dictionary];
+	SCStackOperation *pendingNavigation;
 	
-	if(visible && !self.isRootViewControllerVisible) {
-		self.isRootViewControllerVisible = YES;
-		[self.rootViewController beginAppearanceTransition:YES animated:NO];
-		[self.rootViewController.view setFrame:newRootViewControllerFrame];
-		[self.rootViewController endAppearanceTransition];
-		
-		dispatch_async(dispatch_get_main_queue(), ^{
-			if([self.delegate respondsToSelector:@selector(stackViewController:didShowViewController:position:)]) {
-				[self.delegate stackViewController:self didShowViewController:self.rootViewController position:-1];
-			}
-		});
+	for(SCStackOperation *operation in operations) {
 		
-	} else if(!visible && self.isRootViewControllerVisible) {
-		self.isRootViewControllerVisible = NO;
-		[self.rootViewController beginAppearanceTransition:NO animated:NO];
-		[self.rootViewController.view setFrame:newRootViewControllerFrame];
-		[self.rootViewController endAppearanceTransition];
+		// Only directly consecutive navigations replace each other
+		if(pendingNavigation && operation.type != SCStackOperationTypeRegisterNavigationSteps) {
+			pendingNavigation.cancelled = (operation.type == SCStackOperationTypeNavigate);
+			pendingNavigation = nil;
+		}
 		
-		dispatch_async(dispatch_get_main_queue(), ^{
-			if([self.delegate respondsToSelector:@selector(stackViewController:didHideViewController:position:)]) {
-				[self.delegate stackViewController:self didHideViewController:self.rootViewController position:-1];
+		switch (operation.type) {
+			case SCStackOperationTypePush:
+			{
+				// Pushing an already pushed view controller doesn't add anything for a pop to cancel
+				if([self positionForViewController:operation.viewController] != -1) {
+					break;
+				}
+				
+				// A repeated push is a no-op, or a navigation when unfolding, and must not replace the one a pop cancels
+				if(pendingPushes[@([operation.viewController hash])]) {
+					if(operation.unfold) {
+						[pendingPushes removeObjectForKey:@([operation.viewController hash])];
+					} else {
+						operation.cancelled = YES;
+					}
+					break;
+				}
+				
+				[pendingPushes setObject:operation forKey:@([operation.viewController hash])];
+				break;
 			}
-		});
-		
-	} else {
-		
-		[self.rootViewController.view setFrame:newRootViewControllerFrame];
-		
-		if(hasVerticalControllers) {
-			[self.visiblePercentages setObject:@(roundf((CGRectGetHeight(rootRemainder) * 1000) / CGRectGetHeight(newRootViewControllerFrame))/1000.0f) forKey:@([self.rootViewController hash])];
-		} else if(hasHorizontalController) {
-			[self.visiblePercentages setObject:@(roundf((CGRectGetWidth(rootRemainder) * 1000) / CGRectGetWidth(newRootViewControllerFrame))/1000.0f) forKey:@([self.rootViewController hash])];
+			case SCStackOperationTypePop:
+			{
+				// Popping a view controller that never got on the stack does nothing
+				SCStackOperation *push = pendingPushes[@([operation.viewController hash])];
+				if(push) {
+					push.cancelled = YES;
+					operation.cancelled = YES;
+					[pendingPushes removeObjectForKey:@([operation.viewController hash])];
+				}
+				break;
+			}
+			case SCStackOperationTypePopAtPosition:
+			{
+				// Can't tell which view controller this will pop, so stop coalescing around it
+				[pendingPushes removeAllObjects];
+				break;
+			}
+			case SCStackOperationTypeNavigate:
+			{
+				// Can't skip a push that is being navigated to
+				[pendingPushes removeObjectForKey:@([operation.viewController hash])];
+				pendingNavigation = operation;
+				break;
+			}
+			case SCStackOperationTypeRegisterNavigationSteps:
+			{
+				SCStackOperation *registration = pendingRegistrations[@([operation.viewController hash])];
+				registration.cancelled = YES;
+				[pendingRegistrations setObject:operation forKey:@([operation.viewController hash])];
+				break;
+			}
+		}
+	}
+}
+
+- (void)applyOperation:(SCStackOperation *)operation
+{
+	if(operation.cancelled) {
+		if(operation.completion) {
+			operation.completion();
 		}
+		return;
 	}
 	
-	if([activeLayouter respondsToSelector:@selector(sublayerTransformForRootViewController:contentOffset:inStackController:)]) {
-		CATransform3D transform = [activeLayouter sublayerTransformForRootViewController:self.rootViewController
-																		   contentOffset:offset
-																	   inStackController:self];
-		[self.rootViewController.view.layer setSublayerTransform:transform];
+	switch (operation.type) {
+		case SCStackOperationTypePush:
+		{
+			[self pushViewController:operation.viewController atPosition:operation.position unfold:operation.unfold animated:operation.animated completion:operation.completion];
+			break;
+		}
+		case SCStackOperationTypePop:
+		{
+			if([self positionForViewController:operation.viewController] == -1) {
+				if(operation.completion) {
+					operation.completion();
+				}
+				break;
+			}
+			
+			[self popViewController:operation.viewController animated:operation.animated completion:operation.completion];
+			break;
+		}
+		case SCStackOperationTypePopAtPosition:
+		{
+			[self popViewControllerAtPosition:operation.position animated:operation.animated completion:operation.completion];
+			break;
+		}
+		case SCStackOperationTypeNavigate:
+		{
+			[self navigateToStep:operation.step inViewController:operation.viewController animated:operation.animated completion:operation.completion];
+			break;
+		}
+		case SCStackOperationTypeRegisterNavigationSteps:
+		{
+			[self registerNavigationSteps:operation.navigationSteps forViewController:operation.viewController];
+			if(operation.completion) {
+				operation.completion();
+			}
+			break;
+		}
 	}
 }
 
@@ -1019,63 +2328,223 @@
 			}
 		}
 		
+		// Only the view controllers whose final frames are around the targeted offset can contain it
+		CGPoint indexOffset = adjustedOffset;
+		if(position == SCStackViewControllerPositionBottom) {
+			indexOffset.y += CGRectGetHeight(self.view.bounds);
+		} else if(position == SCStackViewControllerPositionRight) {
+			indexOffset.x += CGRectGetWidth(self.view.bounds);
+		}
+		
 		NSArray *viewControllersArray = self.loadedControllers[@(position)];
 		
-		__block BOOL keepGoing = YES;
+		__block UIViewController *viewController;
+		__block NSUInteger viewControllerIndex = NSNotFound;
 		
-		// Enumerate through all the VCs and figure out which one contains the targeted offset
-		[viewControllersArray enumerateObjectsUsingBlock:^(UIViewController *viewController, NSUInteger index, BOOL *stop) {
+		[self.finalFramesIndex enumerateObjectsIntersectingRect:CGRectMake(indexOffset.x - 1.0f, indexOffset.y - 1.0f, 2.0f, 2.0f) usingBlock:^(UIViewController *candidate, CGRect frame, BOOL *stop) {
+			
+			NSUInteger index = [self.stackIndexes[@([candidate hash])] unsignedIntegerValue];
+			if(index >= viewControllersArray.count || viewControllersArray[index] != candidate || index >= viewControllerIndex) {
+				return;
+			}
 			
-			CGRect frame = [self.finalFrames[@(viewController.hash)] CGRectValue];
 			frame.origin.x = frame.origin.x > 0.0f ? CGRectGetMinX(frame) - CGRectGetWidth(self.view.bounds) : CGRectGetMinX(frame);
 			frame.origin.y = frame.origin.y > 0.0f ? CGRectGetMinY(frame) - CGRectGetHeight(self.view.bounds) : CGRectGetMinY(frame);
 			
 			frame = CGRectOffset(CGRectInset(frame, -0.5f, -0.5f), 0.5f, 0.5f); //consider the maximum X and maximum Y edges
 			
+			// Keep the first view controller in the stack that contains the offset
 			if(CGRectContainsPoint(frame, adjustedOffset)) {
-				
-				// If the velocity is zero then jump to the closest navigation step
-				if(CGPointEqualToPoint(CGPointZero, velocity)) {
+				viewController = candidate;
+				viewControllerIndex = index;
+			}
+		}];
+		
+		if(viewController == nil) {
+			continue;
+		}
+		
+		// If the velocity is zero then jump to the closest navigation step
+		if(CGPointEqualToPoint(CGPointZero, velocity)) {
+			
+			switch (position) {
+				case SCStackViewControllerPositionTop:
+				case SCStackViewControllerPositionBottom:
+				{
+					CGPoint previousStepOffset = [self nextStepOffsetForViewController:viewController position:position velocity:CGPointMake(0.0f, -1.0f) reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
+					CGPoint nextStepOffset = [self nextStepOffsetForViewController:viewController position:position velocity:CGPointMake(0.0f, 1.0f) reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
 					
-					switch (position) {
-						case SCStackViewControllerPositionTop:
-						case SCStackViewControllerPositionBottom:
-						{
-							CGPoint previousStepOffset = [self nextStepOffsetForViewController:viewController position:position velocity:CGPointMake(0.0f, -1.0f) reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
-							CGPoint nextStepOffset = [self nextStepOffsetForViewController:viewController position:position velocity:CGPointMake(0.0f, 1.0f) reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
-							
-							*targetContentOffset = ABS(targetContentOffset->y - previousStepOffset.y) > ABS(targetContentOffset->y - nextStepOffset.y) ? nextStepOffset : previousStepOffset;
-							break;
-						}
-						case SCStackViewControllerPositionLeft:
-						case SCStackViewControllerPositionRight:
-						{
-							CGPoint previousStepOffset = [self nextStepOffsetForViewController:viewController position:position velocity:CGPointMake(-1.0f, 0.0f) reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
-							CGPoint nextStepOffset = [self nextStepOffsetForViewController:viewController position:position velocity:CGPointMake(1.0f, 0.0f) reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
-							
-							*targetContentOffset = ABS(targetContentOffset->x - previousStepOffset.x) > ABS(targetContentOffset->x - nextStepOffset.x) ? nextStepOffset : previousStepOffset;
-							break;
-						}
-					}
+					*targetContentOffset = ABS(targetContentOffset->y - previousStepOffset.y) > ABS(targetContentOffset->y - nextStepOffset.y) ? nextStepOffset : previousStepOffset;
+					break;
+				}
+				case SCStackViewControllerPositionLeft:
+				case SCStackViewControllerPositionRight:
+				{
+					CGPoint previousStepOffset = [self nextStepOffsetForViewController:viewController position:position velocity:CGPointMake(-1.0f, 0.0f) reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
+					CGPoint nextStepOffset = [self nextStepOffsetForViewController:viewController position:position velocity:CGPointMake(1.0f, 0.0f) reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
 					
-				} else {
-					// Calculate the next step of the pagination (either a navigationStep or a controller edge)
-					*targetContentOffset = [self nextStepOffsetForViewController:viewController position:position velocity:velocity reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
+					*targetContentOffset = ABS(targetContentOffset->x - previousStepOffset.x) > ABS(targetContentOffset->x - nextStepOffset.x) ? nextStepOffset : previousStepOffset;
+					break;
 				}
-				
-				keepGoing = NO;
-				*stop = YES;
 			}
-		}];
-		
-		if(!keepGoing) {
-			return;
+			
+		} else {
+			// Calculate the next step of the pagination (either a navigationStep or a controller edge)
+			*targetContentOffset = [self nextStepOffsetForViewController:viewController position:position velocity:velocity reversed:isReversed contentOffset:*targetContentOffset paginating:YES];
 		}
+		
+		return;
 	}
 }
 
 #pragma mark Shared
 
+// Offset along the position's axis at which the given percentage of the view controller is unfolded
+- (CGFloat)offsetForNavigationStepPercentage:(CGFloat)percentage
+							inViewController:(UIViewController *)viewController
+									position:(SCStackViewControllerPosition)position
+									reversed:(BOOL)isReversed
+								maximumInset:(CGPoint)maximumInset
+{
+	CGRect finalFrame = [self.finalFrames[@(viewController.hash)] CGRectValue];
+	
+	switch (position) {
+		case SCStackViewControllerPositionTop:
+			if(isReversed) {
+				return maximumInset.y - CGRectGetMaxY(finalFrame) + CGRectGetHeight(finalFrame) * (1.0f - percentage);
+			}
+			return CGRectGetMaxY(finalFrame) - CGRectGetHeight(finalFrame) * percentage;
+		case SCStackViewControllerPositionLeft:
+			if(isReversed) {
+				return maximumInset.x - CGRectGetMaxX(finalFrame) + CGRectGetWidth(finalFrame) * (1.0f - percentage);
+			}
+			return CGRectGetMaxX(finalFrame) - CGRectGetWidth(finalFrame) * percentage;
+		case SCStackViewControllerPositionBottom:
+			if(isReversed) {
+				return maximumInset.y - CGRectGetMaxY(finalFrame) + CGRectGetHeight(finalFrame) * percentage + CGRectGetHeight(self.view.bounds);
+			}
+			return CGRectGetMinY(finalFrame) + CGRectGetHeight(finalFrame) * percentage - CGRectGetHeight(self.view.bounds);
+		case SCStackViewControllerPositionRight:
+			if(isReversed) {
+				return maximumInset.x - CGRectGetMaxX(finalFrame) + CGRectGetWidth(finalFrame) * percentage + CGRectGetWidth(self.view.bounds);
+			}
+			return CGRectGetMinX(finalFrame) + CGRectGetWidth(finalFrame) * percentage - CGRectGetWidth(self.view.bounds);
+	}
+	
+	return 0.0f;
+}
+
+// Forward blocking steps stop the Stack while unfolding, reverse blocking ones while folding
+- (BOOL)navigationStep:(SCStackNavigationStep *)step blocksVelocity:(CGPoint)velocity atPosition:(SCStackViewControllerPosition)position
+{
+	BOOL isUnfolding = ((velocity.y < 0.0f && position == SCStackViewControllerPositionTop)    || (velocity.x < 0.0f && position == SCStackViewControllerPositionLeft) ||
+						(velocity.y > 0.0f && position == SCStackViewControllerPositionBottom) || (velocity.x > 0.0f && position == SCStackViewControllerPositionRight));
+	
+	BOOL isFolding = ((velocity.y > 0.0f && position == SCStackViewControllerPositionTop)    || (velocity.x > 0.0f && position == SCStackViewControllerPositionLeft) ||
+					  (velocity.y < 0.0f && position == SCStackViewControllerPositionBottom) || (velocity.x < 0.0f && position == SCStackViewControllerPositionRight));
+	
+	return ((step.blockType == SCStackNavigationStepBlockTypeForward && isUnfolding) || (step.blockType == SCStackNavigationStepBlockTypeReverse && isFolding));
+}
+
+// Maps the given offset to the view controller it unfolds, its navigation step at or before the offset and the progress towards the next one.
+// Nothing is cached between queries but the lookups still box the view controllers' hashes like the rest of the Stack.
+- (BOOL)resolveNavigationStep:(SCStackStepResolution *)resolution forContentOffset:(CGPoint)contentOffset
+{
+	SCStackViewControllerPosition position;
+	if(contentOffset.y < 0.0f) {
+		position = SCStackViewControllerPositionTop;
+	} else if(contentOffset.x < 0.0f) {
+		position = SCStackViewControllerPositionLeft;
+	} else if(contentOffset.y > 0.0f) {
+		position = SCStackViewControllerPositionBottom;
+	} else if(contentOffset.x > 0.0f) {
+		position = SCStackViewControllerPositionRight;
+	} else {
+		return NO;
+	}
+	
+	NSArray *viewControllers = self.loadedControllers[@(position)];
+	if(viewControllers.count == 0) {
+		return NO;
+	}
+	
+	BOOL isReversed = NO;
+	if([self.layouters[@(position)] respondsToSelector:@selector(isReversed)]) {
+		isReversed = [self.layouters[@(position)] isReversed];
+	}
+	
+	BOOL isVertical = (position == SCStackViewControllerPositionTop || position == SCStackViewControllerPositionBottom);
+	CGFloat offset = (isVertical ? contentOffset.y : contentOffset.x);
+	CGPoint maximumInset = (isReversed ? [self maximumInsetForPosition:position] : CGPointZero);
+	
+	// The view controllers unfold one after the other, find the first one that the offset doesn't go past
+	NSUInteger low = 0, high = viewControllers.count;
+	while(low < high) {
+		NSUInteger middle = (low + high) / 2;
+		
+		CGFloat start = [self offsetForNavigationStepPercentage:0.0f inViewController:viewControllers[middle] position:position reversed:isReversed maximumInset:maximumInset];
+		CGFloat end = [self offsetForNavigationStepPercentage:1.0f inViewController:viewControllers[middle] position:position reversed:isReversed maximumInset:maximumInset];
+		
+		if((end - offset) * (end - start) < -navigationStepOffsetTolerance * ABS(end - start)) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	
+	UIViewController *viewController = viewControllers[MIN(low, viewControllers.count - 1)];
+	
+	CGFloat start = [self offsetForNavigationStepPercentage:0.0f inViewController:viewController position:position reversed:isReversed maximumInset:maximumInset];
+	CGFloat length = [self offsetForNavigationStepPercentage:1.0f inViewController:viewController position:position reversed:isReversed maximumInset:maximumInset] - start;
+	
+	if(ABS(length) < navigationStepOffsetTolerance) {
+		return NO;
+	}
+	
+	CGFloat percentage = MIN(MAX((offset - start) / length, 0.0f), 1.0f);
+	CGFloat tolerance = navigationStepOffsetTolerance / ABS(length);
+	
+	// Sub-point differences left over after decelerating shouldn't matter
+	if(1.0f - percentage <= tolerance) {
+		percentage = 1.0f;
+	} else if(percentage <= tolerance) {
+		percentage = 0.0f;
+	}
+	
+	resolution->viewController = viewController;
+	resolution->percentage = percentage;
+	resolution->stepIndex = NSNotFound;
+	resolution->progress = 0.0f;
+	resolution->isOnStep = NO;
+	
+	// Navigation steps are sorted by percentage, find the last one at or before the offset
+	NSArray *navigationSteps = (self.previousNavigationSteps[@([viewController hash])] ?: self.navigationSteps[@([viewController hash])]);
+	
+	low = 0, high = navigationSteps.count;
+	while(low < high) {
+		NSUInteger middle = (low + high) / 2;
+		if([(SCStackNavigationStep *)navigationSteps[middle] percentage] <= percentage + tolerance) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	
+	CGFloat previousPercentage = 0.0f;
+	if(low > 0) {
+		resolution->stepIndex = low - 1;
+		previousPercentage = [(SCStackNavigationStep *)navigationSteps[low - 1] percentage];
+		resolution->isOnStep = (ABS(percentage - previousPercentage) <= tolerance);
+	}
+	
+	CGFloat nextPercentage = (low < navigationSteps.count ? [(SCStackNavigationStep *)navigationSteps[low] percentage] : 1.0f);
+	if(!resolution->isOnStep && nextPercentage > previousPercentage) {
+		resolution->progress = (percentage - previousPercentage) / (nextPercentage - previousPercentage);
+	}
+	
+	return YES;
+}
+
 - (CGPoint)nextStepOffsetForViewController:(UIViewController *)viewController
 								  position:(SCStackViewControllerPosition)position
 								  velocity:(CGPoint)velocity
@@ -1096,54 +2565,32 @@
 		navigationSteps = [[navigationSteps reverseObjectEnumerator] allObjects];
 	}
 	
+	BOOL isVertical = (position == SCStackViewControllerPositionTop || position == SCStackViewControllerPositionBottom);
+	CGFloat direction = (isVertical ? velocity.y : velocity.x);
+	CGPoint maximumInset = (isReversed ? [self maximumInsetForPosition:position] : CGPointZero);
+	
 	// Fetch the next navigation step and calculate its offset
 	for(SCStackNavigationStep *nextStep in navigationSteps) {
 		
-		if(position == SCStackViewControllerPositionTop) {
-			if(isReversed) {
-				nextStepOffset.y = [self maximumInsetForPosition:position].y - CGRectGetMaxY(finalFrame) + CGRectGetHeight(finalFrame) * (1.0f - nextStep.percentage);
-			} else {
-				nextStepOffset.y = CGRectGetMaxY(finalFrame) - CGRectGetHeight(finalFrame) * nextStep.percentage;
-			}
-		} else if(position == SCStackViewControllerPositionLeft) {
-			if(isReversed) {
-				nextStepOffset.x = [self maximumInsetForPosition:position].x - CGRectGetMaxX(finalFrame) + CGRectGetWidth(finalFrame) * (1.0f - nextStep.percentage);
-			} else {
-				nextStepOffset.x = CGRectGetMaxX(finalFrame) - CGRectGetWidth(finalFrame) * nextStep.percentage;
-			}
-		} else if(position == SCStackViewControllerPositionBottom) {
-			if(isReversed) {
-				nextStepOffset.y = [self maximumInsetForPosition:position].y - CGRectGetMaxY(finalFrame) + CGRectGetHeight(finalFrame) * nextStep.percentage + CGRectGetHeight(self.view.bounds);
-			} else {
-				nextStepOffset.y = CGRectGetMinY(finalFrame) + CGRectGetHeight(finalFrame) * nextStep.percentage - CGRectGetHeight(self.view.bounds);
-			}
-		} else if(position == SCStackViewControllerPositionRight) {
-			if(isReversed) {
-				nextStepOffset.x = [self maximumInsetForPosition:position].x - CGRectGetMaxX(finalFrame) + CGRectGetWidth(finalFrame) * nextStep.percentage + CGRectGetWidth(self.view.bounds);
-			} else {
-				nextStepOffset.x = CGRectGetMinX(finalFrame) + CGRectGetWidth(finalFrame) * nextStep.percentage - CGRectGetWidth(self.view.bounds);
-			}
+		if(direction == 0.0f) {
+			break;
 		}
 		
-		nextStepOffset.x = roundf(nextStepOffset.x);
-		nextStepOffset.y = roundf(nextStepOffset.y);
+		CGFloat offset = roundf([self offsetForNavigationStepPercentage:nextStep.percentage inViewController:viewController position:position reversed:isReversed maximumInset:maximumInset]);
+		CGFloat distance = (offset - (isVertical ? contentOffset.y : contentOffset.x)) * (direction > 0.0f ? 1.0f : -1.0f);
 		
-		// Cache the steps to avoid having to recalculate them later. Will clear the cache when the pagination is done.
-		[self.stepsForOffsets setObject:nextStep forKey:[NSValue valueWithCGPoint:nextStepOffset]];
+		if(isVertical) {
+			nextStepOffset.y = offset;
+		} else {
+			nextStepOffset.x = offset;
+		}
 		
-		if(!paginating) {
-			// Trick the calculations into blocking
-			if(nextStep.blockType == SCStackNavigationStepBlockTypeForward) {
-				nextStepOffset.y -= 0.01f;
-			}
-			
-			if(nextStep.blockType == SCStackNavigationStepBlockTypeReverse) {
-				nextStepOffset.y += 0.01f;
-			}
+		// Steps the offset is resting on only count when they block the current direction
+		if(distance > navigationStepOffsetTolerance) {
+			return nextStepOffset;
 		}
 		
-		if((velocity.y > 0.0f && nextStepOffset.y > contentOffset.y) || (velocity.y < 0.0f && nextStepOffset.y < contentOffset.y) ||
-		   (velocity.x > 0.0f && nextStepOffset.x > contentOffset.x) || (velocity.x < 0.0f && nextStepOffset.x < contentOffset.x)) {
+		if(!paginating && ABS(distance) <= navigationStepOffsetTolerance && [self navigationStep:nextStep blocksVelocity:velocity atPosition:position]) {
 			return nextStepOffset;
 		}
 	}
@@ -1195,13 +2642,17 @@
 - (void)stackViewControllerViewDidChangeFrame:(SCStackViewControllerView *)stackViewControllerView
 {
 	[self.scrollView setDelegate:self];
+	
+	if(self.sc_stackViewController) {
+		[[SCStackLayoutScheduler sharedScheduler] scheduleLayoutForStackViewController:self];
+	}
 }
 
 #pragma mark - UIScrollViewDelegate
 
 - (void)scrollViewDidScroll:(UIScrollView *)scrollView
 {
-	[self updateFramesAndTriggerAppearanceCallbacks];
+	[self updateFramesAndTriggerAppearanceCallbacksSkippingIdleAxes:YES];
 	
 	if(self.didIgnoreNavigationalConstraints) {
 		[self updateBoundsUsingNavigationContraints];
@@ -1222,21 +2673,34 @@
 	UIViewController *lastVisibleViewController = [self.visibleViewControllers lastObject];
 	
 	SCStackNavigationStep *step;
+	SCStackStepResolution resolution;
 	if(lastVisibleViewController == nil) {
 		step = [SCStackNavigationStep navigationStepWithPercentage:0.0f];
-	} else {
-		step = [self.stepsForOffsets objectForKey:[NSValue valueWithCGPoint:self.scrollView.contentOffset]];
+	} else if([self resolveNavigationStep:&resolution forContentOffset:self.scrollView.contentOffset]) {
+		lastVisibleViewController = resolution.viewController;
 		
-		if(step == nil) {
-			step = [SCStackNavigationStep navigationStepWithPercentage:1.0f];
+		NSArray *navigationSteps = (self.previousNavigationSteps[@([lastVisibleViewController hash])] ?: self.navigationSteps[@([lastVisibleViewController hash])]);
+		if(resolution.isOnStep) {
+			step = navigationSteps[resolution.stepIndex];
+		} else {
+			step = [SCStackNavigationStep navigationStepWithPercentage:resolution.percentage];
 		}
+	} else {
+		step = [SCStackNavigationStep navigationStepWithPercentage:1.0f];
 	}
 	
 	if([self.delegate respondsToSelector:@selector(stackViewController:didNavigateToStep:inViewController:)]) {
 		[self.delegate stackViewController:self didNavigateToStep:step inViewController:lastVisibleViewController];
 	}
-	
-	[self.stepsForOffsets removeAllObjects];
+}
+
+- (void)scrollViewWillBeginDragging:(UIScrollView *)scrollView
+{
+	// Gestures starting on the root get locked to a single axis
+	if(CGPointEqualToPoint(self.scrollView.contentOffset, CGPointZero)) {
+		self.draggingAxis = [self axisForVelocity:[self.scrollView.panGestureRecognizer velocityInView:self.scrollView]];
+		[self.scrollView setContentInset:[self insetsByLockingAxis:self.scrollView.contentInset]];
+	}
 }
 
 - (void)scrollViewDidEndDecelerating:(UIScrollView *)scrollView
@@ -1246,6 +2710,8 @@
 		return;
 	}
 	
+	self.draggingAxis = SCStackAxisNone;
+	
 	[self updateBoundsUsingNavigationContraints];
 	[self triggerNavigationStepsDelegateCalls];
 }
@@ -1259,6 +2725,8 @@
 - (void)scrollViewDidEndDragging:(UIScrollView *)scrollView willDecelerate:(BOOL)decelerate
 {
 	if(decelerate == NO) {
+		self.draggingAxis = SCStackAxisNone;
+		
 		[self updateBoundsUsingNavigationContraints];
 		[self triggerNavigationStepsDelegateCalls];
 	}
@@ -1296,46 +2764,115 @@
 
 - (CGPoint)maximumInsetForPosition:(SCStackViewControllerPosition)position
 {
+	CGSize summedSize = [self summedSizeForViewControllersAtPosition:position];
+	
 	switch (position) {
 		case SCStackViewControllerPositionTop:
-			return CGPointMake(0, -[[self.loadedControllers[@(position)] valueForKeyPath:@"@sum.sc_viewHeight"] floatValue]);
+			return CGPointMake(0, -summedSize.height);
 		case SCStackViewControllerPositionLeft:
-			return CGPointMake(-[[self.loadedControllers[@(position)] valueForKeyPath:@"@sum.sc_viewWidth"] floatValue], 0);
+			return CGPointMake(-summedSize.width, 0);
 		case SCStackViewControllerPositionBottom:
-			return CGPointMake(0, [[self.loadedControllers[@(position)] valueForKeyPath:@"@sum.sc_viewHeight"] floatValue]);
+			return CGPointMake(0, summedSize.height);
 		case SCStackViewControllerPositionRight:
-			return CGPointMake([[self.loadedControllers[@(position)] valueForKeyPath:@"@sum.sc_viewWidth"] floatValue], 0);
+			return CGPointMake(summedSize.width, 0);
 		default:
 			return CGPointZero;
 	}
 }
 
-- (SCStackViewControllerPosition)positionForViewController:(UIViewController *)viewController
+- (BOOL)sizeHint:(CGSize *)size forViewController:(UIViewController *)viewController
 {
-	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
-		if([self.loadedControllers[@(position)] containsObject:viewController]) {
-			return position;
+	if([viewController isEqual:self.rootViewController]) {
+		return NO;
+	}
+	
+	CGSize sizeHint = CGSizeZero;
+	
+	if([self.delegate respondsToSelector:@selector(stackViewController:sizeForViewController:position:)]) {
+		sizeHint = [self.delegate stackViewController:self sizeForViewController:viewController position:[self positionForViewController:viewController]];
+	}
+	
+	// preferredContentSize is only available on iOS 7 and above
+	if(CGSizeEqualToSize(sizeHint, CGSizeZero) && [viewController respondsToSelector:@selector(preferredContentSize)]) {
+		sizeHint = viewController.preferredContentSize;
+	}
+	
+	if(CGSizeEqualToSize(sizeHint, CGSizeZero)) {
+		return NO;
+	}
+	
+	// Missing dimensions are stretched to the stack's
+	if(sizeHint.width <= 0.0f) {
+		sizeHint.width = CGRectGetWidth(self.view.bounds);
+	}
+	
+	if(sizeHint.height <= 0.0f) {
+		sizeHint.height = CGRectGetHeight(self.view.bounds);
+	}
+	
+	if(size) {
+		*size = sizeHint;
+	}
+	
+	return YES;
+}
+
+- (BOOL)hasSizeHintForViewController:(UIViewController *)viewController
+{
+	return [self sizeHint:NULL forViewController:viewController];
+}
+
+- (BOOL)isViewInsertedForViewController:(UIViewController *)viewController
+{
+	return (viewController.isViewLoaded && viewController.view.superview == self.scrollView);
+}
+
+// Newer view controllers always sit below the older ones on the same position
+- (void)insertViewForViewController:(UIViewController *)viewController atPosition:(SCStackViewControllerPosition)position
+{
+	[self.appliedFrames removeObjectForKey:@([viewController hash])];
+	[self.appliedSublayerTransforms removeObjectForKey:@([viewController hash])];
+	
+	NSArray *viewControllers = self.loadedControllers[@(position)];
+	NSUInteger index = [self.stackIndexes[@([viewController hash])] unsignedIntegerValue];
+	
+	for(NSUInteger i = index + 1; i < viewControllers.count; i++) {
+		UIViewController *newerViewController = viewControllers[i];
+		if([self isViewInsertedForViewController:newerViewController]) {
+			[self.scrollView insertSubview:viewController.view aboveSubview:newerViewController.view];
+			return;
 		}
 	}
 	
-	return -1;
+	id<SCStackLayouterProtocol> layouter = self.layouters[@(position)];
+	
+	BOOL shouldStackAboveRoot = NO;
+	if([layouter respondsToSelector:@selector(shouldStackControllersAboveRoot)]) {
+		shouldStackAboveRoot = [layouter shouldStackControllersAboveRoot];
+	}
+	
+	if(shouldStackAboveRoot) {
+		[self.scrollView insertSubview:viewController.view aboveSubview:self.rootViewController.view];
+	} else {
+		[self.scrollView insertSubview:viewController.view atIndex:0];
+	}
 }
 
-- (CGRectEdge)edgeFromOffset:(CGPoint)offset
+- (SCStackViewControllerPosition)positionForViewController:(UIViewController *)viewController
 {
-	CGRectEdge edge = -1;
+	NSNumber *stackPosition = self.stackPositions[@([viewController hash])];
+	if(stackPosition) {
+		return [stackPosition integerValue];
+	}
 	
-	if(offset.x > 0.0f) {
-		edge = CGRectMinXEdge;
-	} else if(offset.x < 0.0f) {
-		edge = CGRectMaxXEdge;
-	} else if(offset.y > 0.0f) {
-		edge = CGRectMinYEdge;
-	} else if(offset.y < 0.0f) {
-		edge = CGRectMaxYEdge;
+	// Not laid out yet
+	for(SCStackViewControllerPosition position = SCStackViewControllerPositionTop; position <= SCStackViewControllerPositionRight; position++) {
+		if([self.loadedControllers[@(position)] containsObject:viewController]) {
+			return position;
+		}
 	}
 	
-	return edge;
+	return -1;
 }
 
 UIEdgeInsets UIEdgeInsetsIntegral(UIEdgeInsets edgeInsets)
@@ -1348,24 +2885,6 @@ UIEdgeInsets UIEdgeInsetsIntegral(UIEdgeInsets edgeInsets)
 	return edgeInsets;
 }
 
-- (CGRect)subtractRect:(CGRect)r2 fromRect:(CGRect)r1 withEdge:(CGRectEdge)edge
-{
-	if(CGRectEqualToRect(r1, r2)) {
-		return CGRectZero;
-	}
-	
-	CGRect intersection = CGRectIntersection(r1, r2);
-	if (CGRectIsNull(intersection)) {
-		return r1;
-	}
-	
-	float chopAmount = (edge == CGRectMinXEdge || edge == CGRectMaxXEdge) ? CGRectGetWidth(intersection) : CGRectGetHeight(intersection);
-	
-	CGRect remainder, throwaway;
-	CGRectDivide(r1, &throwaway, &remainder, chopAmount, edge);
-	return remainder;
-}
-
 @end
 
 
@@ -1384,11 +2903,19 @@ UIEdgeInsets UIEdgeInsetsIntegral(UIEdgeInsets edgeInsets)
 
 - (CGFloat)sc_viewWidth
 {
+	if([self.parentViewController isKindOfClass:[SCStackViewController class]]) {
+		return [(SCStackViewController *)self.parentViewController sizeForViewController:self].width;
+	}
+	
 	return CGRectGetWidth(self.view.bounds);
 }
 
 - (CGFloat)sc_viewHeight
 {
+	if([self.parentViewController isKindOfClass:[SCStackViewController class]]) {
+		return [(SCStackViewController *)self.parentViewController sizeForViewController:self].height;
+	}
+	
 	return CGRectGetHeight(self.view.bounds);
 }
 
@@ -12,6 +12,12 @@
 
 - (void)setFrame:(CGRect)frame
 {
+	// Origin only changes don't affect the Stack's layout
+	if(CGSizeEqualToSize(frame.size, self.frame.size)) {
+		super.frame = frame;
+		return;
+	}
+	
 	[self.delegate stackViewControllerViewWillChangeFrame:self];
 	
 	super.frame = frame;